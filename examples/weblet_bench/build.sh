@@ -0,0 +1,2 @@
+mkdir -p bin
+g++ -Wall -Weffc++ -std=c++20 -O2 -Iinclude -o bin/weblet_bench examples/weblet_bench/weblet_bench.cpp src/purple/cron/* src/purple/concurrent/* src/purple/net/* src/purple/sys/* -lz
@@ -0,0 +1,807 @@
+#include <purple/net/event_loop.hpp>
+#include <purple/net/metrics.hpp>
+#include <purple/net/weblet.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+using namespace Purple::Net;
+
+static const char *scenario_names[] = {"static", "json", "routing", "upload",
+                                       "slow"};
+static const size_t route_patterns = 500;
+static const long long drain_grace_ns = 5000000000LL;
+
+struct BenchOptions {
+  std::vector<std::string> scenarios{};
+  double rate = 20000;
+  double duration = 10;
+  double warmup = 2;
+  size_t connections = 64;
+  size_t threads = 2;
+  size_t pipeline = 1;
+  bool keep_alive = true;
+  size_t slow_clients = 256;
+  size_t server_threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t event_loops = 1;
+  bool io_uring = false;
+  int port = 18480;
+  std::string baseline{};
+  std::string save{};
+};
+
+struct Scenario {
+  std::string name{};
+  std::vector<std::string> requests{};
+  bool slow_clients = false;
+};
+
+struct ClientConnection {
+  int fd = -1;
+  uint32_t generation = 0;
+  bool connected = false;
+  std::string output{};
+  std::string input{};
+  std::deque<long long> inflight{};
+};
+
+struct ClientStats {
+  std::unique_ptr<LatencyHistogram> latencies =
+      std::make_unique<LatencyHistogram>();
+  uint64_t completed = 0;
+  uint64_t errors = 0;
+  uint64_t timeouts = 0;
+};
+
+struct BenchResult {
+  std::string scenario{};
+  double throughput = 0;
+  uint64_t p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0;
+  uint64_t errors = 0;
+};
+
+static std::string request_head(const std::string &method,
+                                const std::string &path,
+                                const std::string &extra, bool keep_alive) {
+  return method + " " + path +
+         " HTTP/1.1\r\nHost: localhost\r\nUser-Agent: weblet_bench\r\n" +
+         (keep_alive ? "" : "Connection: close\r\n") + extra + "\r\n";
+}
+
+static Scenario build_scenario(const std::string &name,
+                               const BenchOptions &options) {
+  Scenario scenario{name, {}, false};
+  std::mt19937_64 random(42);
+
+  if (name == "static")
+    scenario.requests.push_back(
+        request_head("GET", "/index.html", "", options.keep_alive));
+  else if (name == "json" || name == "slow") {
+    scenario.requests.push_back(
+        request_head("GET", "/api/json", "", options.keep_alive));
+    scenario.slow_clients = name == "slow";
+  } else if (name == "routing")
+    for (size_t i = 0; i < 1024; i++)
+      scenario.requests.push_back(request_head(
+          "GET",
+          "/api/v1/resource" + std::to_string(random() % route_patterns) +
+              "/" + std::to_string(random() % 100000) + "/items/" +
+              std::to_string(random() % 1000),
+          "", options.keep_alive));
+  else if (name == "upload") {
+    std::string boundary = "----weblet-bench-boundary";
+    std::string file(16384, 'x');
+
+    for (char &c : file)
+      c = static_cast<char>('a' + random() % 26);
+
+    std::string body = "--" + boundary +
+                       "\r\nContent-Disposition: form-data; "
+                       "name=\"description\"\r\n\r\nbenchmark upload\r\n--" +
+                       boundary +
+                       "\r\nContent-Disposition: form-data; name=\"file\"; "
+                       "filename=\"bench.txt\"\r\nContent-Type: "
+                       "text/plain\r\n\r\n" +
+                       file + "\r\n--" + boundary + "--\r\n";
+
+    scenario.requests.push_back(
+        request_head("POST", "/upload",
+                     "Content-Type: multipart/form-data; boundary=" +
+                         boundary + "\r\nContent-Length: " +
+                         std::to_string(body.size()) + "\r\n",
+                     options.keep_alive) +
+        body);
+  }
+
+  return scenario;
+}
+
+static std::filesystem::path create_public_dir() {
+  std::filesystem::path public_dir =
+      std::filesystem::temp_directory_path() / "weblet_bench_public";
+  std::filesystem::create_directories(public_dir);
+
+  std::ofstream index(public_dir / "index.html");
+  index << "<!DOCTYPE html><html><head><title>weblet_bench</title></head>"
+           "<body>";
+  for (int line = 0; line < 64; line++)
+    index << "<p>Static benchmark payload, line " << line << ".</p>\n";
+  index << "</body></html>";
+
+  return public_dir;
+}
+
+static std::unique_ptr<Weblet> start_server(const BenchOptions &options,
+                                            const std::string &public_dir,
+                                            std::atomic<uint64_t> &errors) {
+  std::unique_ptr<Weblet> server = std::make_unique<Weblet>(
+      "127.0.0.1", options.port, false, options.server_threads,
+      [&errors](std::string) { errors++; });
+
+  server->set_event_loops(options.event_loops);
+  server->set_io_uring(options.io_uring);
+  server->handle_public(public_dir);
+
+  server->handle("/api/json", [](const RequestContext &) {
+    Response response;
+    response.set_header("Content-Type", "application/json");
+    response.contents = "{\"id\": 1, \"name\": \"weblet\", \"ok\": true}";
+
+    return response;
+  });
+
+  for (size_t i = 0; i < route_patterns; i++)
+    server->handle("/api/v1/resource" + std::to_string(i) +
+                       "/{id}/items/{item}",
+                   [](const RequestContext &context) {
+                     Response response;
+                     response.set_header("Content-Type", "application/json");
+                     response.contents =
+                         "{\"id\": \"" + std::string(context.param("id")) +
+                         "\", \"item\": \"" +
+                         std::string(context.param("item")) + "\"}";
+
+                     return response;
+                   });
+
+  server->handle("/upload", [](const RequestContext &context) {
+    size_t bytes = 0;
+    for (const auto &[field, file] : context.request.upload_files)
+      bytes += file.size;
+
+    Response response;
+    response.set_header("Content-Type", "application/json");
+    response.contents = "{\"received\": " + std::to_string(bytes) + "}";
+
+    return response;
+  });
+
+  server->start();
+  return server;
+}
+
+static int open_connection(int port, bool blocking) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC |
+                               (blocking ? 0 : SOCK_NONBLOCK),
+                  0);
+  if (fd == -1)
+    return -1;
+
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) ==
+          -1 &&
+      errno != EINPROGRESS) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+static void reconnect(int epoll_desc, ClientConnection &connection,
+                      size_t index, int port) {
+  if (connection.fd != -1)
+    close(connection.fd);
+
+  connection.generation++;
+  connection.connected = false;
+  connection.output.clear();
+  connection.input.clear();
+  connection.inflight.clear();
+  connection.fd = open_connection(port, false);
+
+  if (connection.fd == -1)
+    return;
+
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  event.data.u64 = (static_cast<uint64_t>(connection.generation) << 32) | index;
+  epoll_ctl(epoll_desc, EPOLL_CTL_ADD, connection.fd, &event);
+}
+
+static bool flush_output(ClientConnection &connection) {
+  while (!connection.output.empty()) {
+    ssize_t written = send(connection.fd, connection.output.data(),
+                           connection.output.size(), MSG_NOSIGNAL);
+
+    if (written > 0)
+      connection.output.erase(0, written);
+    else if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return true;
+    else
+      return false;
+  }
+
+  return true;
+}
+
+static bool header_value(std::string_view head, std::string_view name,
+                         std::string_view &value) {
+  size_t line = head.find("\r\n");
+
+  while (line != std::string_view::npos) {
+    line += 2;
+    size_t end = head.find("\r\n", line);
+    std::string_view field = head.substr(line, end - line);
+
+    if (field.size() > name.size() && field[name.size()] == ':' &&
+        strncasecmp(field.data(), name.data(), name.size()) == 0) {
+      value = field.substr(name.size() + 1);
+      while (!value.empty() && value.front() == ' ')
+        value.remove_prefix(1);
+
+      return true;
+    }
+
+    line = end;
+  }
+
+  return false;
+}
+
+// Consumes the complete responses at the start of the input; returns false
+// if the connection must be reopened.
+static bool read_responses(ClientConnection &connection, ClientStats &stats,
+                           long long measure_from, long long now) {
+  while (!connection.inflight.empty()) {
+    size_t head_end = connection.input.find("\r\n\r\n");
+    if (head_end == std::string::npos)
+      return true;
+
+    std::string_view head(connection.input.data(), head_end + 2);
+    int status = head.size() > 12 ? std::atoi(head.data() + 9) : 0;
+    std::string_view length_value, connection_value;
+    size_t length = 0;
+
+    if (header_value(head, "Content-Length", length_value))
+      length = std::strtoull(std::string(length_value).c_str(), nullptr, 10);
+    else if (status != 204 && status != 304)
+      return false;
+
+    if (connection.input.size() < head_end + 4 + length)
+      return true;
+
+    bool closing = header_value(head, "Connection", connection_value) &&
+                   strncasecmp(connection_value.data(), "close", 5) == 0;
+    long long intended = connection.inflight.front();
+    connection.inflight.pop_front();
+
+    if (intended >= measure_from) {
+      if (status >= 200 && status < 400) {
+        stats.latencies->record(now - intended);
+        stats.completed++;
+      } else
+        stats.errors++;
+    }
+
+    connection.input.erase(0, head_end + 4 + length);
+    if (closing)
+      return false;
+  }
+
+  return connection.input.empty();
+}
+
+static void run_client(const BenchOptions &options, const Scenario &scenario,
+                       size_t thread_index, long long started,
+                       long long measure_from, long long measure_until,
+                       ClientStats &stats) {
+  size_t count = options.connections / options.threads +
+                 (thread_index < options.connections % options.threads);
+  size_t depth = options.keep_alive ? std::max<size_t>(options.pipeline, 1)
+                                    : 1;
+  long long interval =
+      static_cast<long long>(1e9 * options.threads / options.rate);
+  long long next_due =
+      started + interval * static_cast<long long>(thread_index) /
+                    static_cast<long long>(options.threads);
+  long long deadline = measure_until + drain_grace_ns;
+
+  int epoll_desc = epoll_create1(EPOLL_CLOEXEC);
+  int timer_desc = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  epoll_event timer_event{};
+  timer_event.events = EPOLLIN;
+  timer_event.data.u64 = UINT64_MAX;
+  epoll_ctl(epoll_desc, EPOLL_CTL_ADD, timer_desc, &timer_event);
+
+  std::vector<ClientConnection> connections(std::max<size_t>(count, 1));
+  for (size_t index = 0; index < connections.size(); index++)
+    reconnect(epoll_desc, connections[index], index, options.port);
+
+  std::deque<long long> backlog;
+  size_t next_request = thread_index, next_connection = 0;
+  epoll_event events[256];
+
+  auto fail = [&](size_t index) {
+    ClientConnection &connection = connections[index];
+    for (long long intended : connection.inflight)
+      if (intended >= measure_from)
+        stats.errors++;
+
+    reconnect(epoll_desc, connection, index, options.port);
+  };
+
+  while (true) {
+    long long now = monotonic_ns();
+    for (; next_due <= now && next_due < measure_until; next_due += interval)
+      backlog.push_back(next_due);
+
+    for (size_t tried = 0; tried < connections.size() && !backlog.empty();
+         tried++) {
+      size_t index = (next_connection + tried) % connections.size();
+      ClientConnection &connection = connections[index];
+
+      if (!connection.connected)
+        continue;
+
+      while (!backlog.empty() && connection.inflight.size() < depth) {
+        connection.output.append(
+            scenario.requests[next_request++ % scenario.requests.size()]);
+        connection.inflight.push_back(backlog.front());
+        backlog.pop_front();
+      }
+
+      if (!flush_output(connection))
+        fail(index);
+    }
+    next_connection = (next_connection + 1) % connections.size();
+
+    bool idle = backlog.empty() &&
+                std::all_of(connections.begin(), connections.end(),
+                            [](const ClientConnection &connection) {
+                              return connection.inflight.empty();
+                            });
+    if ((now >= measure_until && idle) || now >= deadline)
+      break;
+
+    long long wake = next_due < measure_until ? next_due : deadline;
+    itimerspec timer{};
+    timer.it_value.tv_sec = wake / 1000000000LL;
+    timer.it_value.tv_nsec = wake % 1000000000LL;
+    timerfd_settime(timer_desc, TFD_TIMER_ABSTIME, &timer, nullptr);
+
+    int ready = epoll_wait(epoll_desc, events, 256, -1);
+    now = monotonic_ns();
+
+    for (int event = 0; event < ready; event++) {
+      uint64_t data = events[event].data.u64;
+      if (data == UINT64_MAX) {
+        uint64_t expirations;
+        while (read(timer_desc, &expirations, sizeof(expirations)) > 0)
+          ;
+        continue;
+      }
+
+      size_t index = data & 0xffffffff;
+      ClientConnection &connection = connections[index];
+      if (connection.generation != data >> 32 || connection.fd == -1)
+        continue;
+
+      if (events[event].events & EPOLLERR) {
+        fail(index);
+        continue;
+      }
+
+      if (!connection.connected && (events[event].events & EPOLLOUT))
+        connection.connected = true;
+      if ((events[event].events & EPOLLOUT) && !flush_output(connection)) {
+        fail(index);
+        continue;
+      }
+
+      if (!(events[event].events & (EPOLLIN | EPOLLRDHUP)))
+        continue;
+
+      char buffer[65536];
+      bool peer_closed = false;
+      while (true) {
+        ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+
+        if (received > 0)
+          connection.input.append(buffer, received);
+        else {
+          peer_closed = received == 0 ||
+                        (errno != EAGAIN && errno != EWOULDBLOCK);
+          break;
+        }
+      }
+
+      if (!read_responses(connection, stats, measure_from, now) ||
+          peer_closed)
+        fail(index);
+    }
+  }
+
+  for (const ClientConnection &connection : connections) {
+    for (long long intended : connection.inflight)
+      if (intended >= measure_from)
+        stats.timeouts++;
+
+    if (connection.fd != -1)
+      close(connection.fd);
+  }
+
+  for (long long intended : backlog)
+    if (intended >= measure_from)
+      stats.timeouts++;
+
+  close(timer_desc);
+  close(epoll_desc);
+}
+
+// Keeps connections sending one header line per second, never finishing
+// their request, until `until`; returns how many the server closed.
+static uint64_t run_slow_clients(const BenchOptions &options,
+                                 long long until) {
+  std::vector<int> sockets(options.slow_clients, -1);
+  std::vector<long long> next_line(options.slow_clients, 0);
+  uint64_t evicted = 0;
+
+  while (monotonic_ns() < until) {
+    long long now = monotonic_ns();
+
+    for (size_t client = 0; client < sockets.size(); client++) {
+      char probe;
+      if (sockets[client] != -1 &&
+          recv(sockets[client], &probe, 1, MSG_DONTWAIT) != -1) {
+        close(sockets[client]);
+        sockets[client] = -1;
+        evicted++;
+      }
+
+      if (sockets[client] == -1) {
+        sockets[client] = open_connection(options.port, true);
+        if (sockets[client] == -1)
+          continue;
+
+        std::string start = "GET /api/json HTTP/1.1\r\nHost: localhost\r\n";
+        send(sockets[client], start.data(), start.size(), MSG_NOSIGNAL);
+        next_line[client] = now + 1000000000LL * client / sockets.size();
+      } else if (now >= next_line[client]) {
+        send(sockets[client], "X-Slow: 1\r\n", 11, MSG_NOSIGNAL);
+        next_line[client] = now + 1000000000LL;
+      }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  for (int fd : sockets)
+    if (fd != -1)
+      close(fd);
+
+  return evicted;
+}
+
+static uint64_t percentile(const std::vector<uint64_t> &merged,
+                           uint64_t count, double quantile) {
+  uint64_t rank = static_cast<uint64_t>(quantile * count), seen = 0;
+  size_t bucket = 0;
+
+  if (rank < quantile * count || rank == 0)
+    rank++;
+  while ((seen += merged[bucket]) < rank)
+    bucket++;
+
+  return LatencyHistogram::bucket_limit(bucket);
+}
+
+static std::string format_latency(uint64_t nanos) {
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(nanos < 10000000 ? 1 : 2);
+
+  if (nanos < 1000000)
+    text << nanos / 1e3 << "us";
+  else if (nanos < 1000000000)
+    text << nanos / 1e6 << "ms";
+  else
+    text << nanos / 1e9 << "s";
+
+  return text.str();
+}
+
+static BenchResult run_scenario(const BenchOptions &options,
+                                const Scenario &scenario) {
+  long long started = monotonic_ns() + 100000000LL;
+  long long measure_from =
+      started + static_cast<long long>(options.warmup * 1e9);
+  long long measure_until =
+      measure_from + static_cast<long long>(options.duration * 1e9);
+
+  std::vector<ClientStats> stats(options.threads);
+  std::vector<std::thread> clients;
+  uint64_t evicted = 0;
+
+  std::thread slow;
+  if (scenario.slow_clients && options.slow_clients > 0)
+    slow = std::thread([&]() {
+      evicted = run_slow_clients(options, measure_until);
+    });
+
+  for (size_t thread = 0; thread < options.threads; thread++)
+    clients.emplace_back([&, thread]() {
+      run_client(options, scenario, thread, started, measure_from,
+                 measure_until, stats[thread]);
+    });
+
+  for (std::thread &client : clients)
+    client.join();
+  if (slow.joinable())
+    slow.join();
+
+  std::vector<uint64_t> merged(LatencyHistogram::bucket_count);
+  uint64_t total = 0, completed = 0, errors = 0;
+
+  for (const ClientStats &thread : stats) {
+    thread.latencies->merge_into(merged, total);
+    completed += thread.completed;
+    errors += thread.errors + thread.timeouts;
+  }
+
+  BenchResult result;
+  result.scenario = scenario.name;
+  result.throughput = completed / options.duration;
+  result.errors = errors;
+
+  if (completed > 0) {
+    result.p50 = percentile(merged, completed, 0.5);
+    result.p90 = percentile(merged, completed, 0.9);
+    result.p99 = percentile(merged, completed, 0.99);
+    result.p999 = percentile(merged, completed, 0.999);
+    result.max = percentile(merged, completed, 1.0);
+  }
+
+  if (scenario.slow_clients)
+    std::cout << "  (" << options.slow_clients << " slow clients, "
+              << evicted << " closed by the server)" << std::endl;
+
+  return result;
+}
+
+static std::map<std::string, BenchResult>
+load_results(const std::string &path) {
+  std::map<std::string, BenchResult> results;
+  std::ifstream file(path);
+  std::string line;
+
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream fields(line);
+    BenchResult result;
+    fields >> result.scenario >> result.throughput >> result.p50 >>
+        result.p90 >> result.p99 >> result.p999 >> result.max >> result.errors;
+
+    if (fields)
+      results[result.scenario] = result;
+  }
+
+  return results;
+}
+
+static void save_results(const std::string &path,
+                         const std::vector<BenchResult> &results) {
+  std::ofstream file(path);
+  file << "# scenario\treq/s\tp50_ns\tp90_ns\tp99_ns\tp999_ns\tmax_ns"
+          "\terrors\n";
+
+  for (const BenchResult &result : results)
+    file << result.scenario << "\t" << std::fixed << std::setprecision(1)
+         << result.throughput << "\t" << result.p50 << "\t" << result.p90
+         << "\t" << result.p99 << "\t" << result.p999 << "\t" << result.max
+         << "\t" << result.errors << "\n";
+}
+
+static std::string change(double current, double baseline) {
+  if (baseline == 0)
+    return "n/a";
+
+  std::ostringstream text;
+  text << std::showpos << std::fixed << std::setprecision(1)
+       << (current - baseline) * 100 / baseline << "%";
+
+  return text.str();
+}
+
+static void print_result(const BenchResult &result, double rate) {
+  std::cout << std::left << std::setw(10) << result.scenario << std::right
+            << std::setw(10) << std::fixed << std::setprecision(0) << rate
+            << std::setw(12) << std::setprecision(1) << result.throughput
+            << std::setw(10) << format_latency(result.p50) << std::setw(10)
+            << format_latency(result.p90) << std::setw(10)
+            << format_latency(result.p99) << std::setw(10)
+            << format_latency(result.p999) << std::setw(10)
+            << format_latency(result.max) << std::setw(8) << result.errors
+            << std::endl;
+}
+
+static void usage() {
+  std::cout
+      << "Usage: weblet_bench [scenario...] [options]\n\n"
+         "Scenarios: static, json, routing, upload, slow (default: all)\n\n"
+         "Options:\n"
+         "  --rate N            Requests per second, open loop (20000)\n"
+         "  --duration S        Measured seconds per scenario (10)\n"
+         "  --warmup S          Unmeasured seconds before measuring (2)\n"
+         "  --connections N     Client connections (64)\n"
+         "  --threads N         Client threads (2)\n"
+         "  --pipeline N        Requests in flight per connection (1)\n"
+         "  --no-keep-alive     One request per connection\n"
+         "  --slow-clients N    Slow clients of the slow scenario (256)\n"
+         "  --server-threads N  Weblet worker threads (all cores)\n"
+         "  --event-loops N     Weblet event loops (1)\n"
+         "  --io-uring          Use the io_uring backend\n"
+         "  --port N            Port of the benchmarked Weblet (18480)\n"
+         "  --save FILE         Save the results to FILE\n"
+         "  --baseline FILE     Compare the results with a saved run\n";
+}
+
+static bool parse_options(int argc, char **argv, BenchOptions &options) {
+  for (int index = 1; index < argc; index++) {
+    std::string argument = argv[index];
+    bool has_value = index + 1 < argc;
+
+    if (argument == "--no-keep-alive")
+      options.keep_alive = false;
+    else if (argument == "--io-uring")
+      options.io_uring = true;
+    else if (argument.rfind("--", 0) == 0 && !has_value)
+      return false;
+    else if (argument == "--rate")
+      options.rate = std::atof(argv[++index]);
+    else if (argument == "--duration")
+      options.duration = std::atof(argv[++index]);
+    else if (argument == "--warmup")
+      options.warmup = std::atof(argv[++index]);
+    else if (argument == "--connections")
+      options.connections = std::strtoul(argv[++index], nullptr, 10);
+    else if (argument == "--threads")
+      options.threads = std::strtoul(argv[++index], nullptr, 10);
+    else if (argument == "--pipeline")
+      options.pipeline = std::strtoul(argv[++index], nullptr, 10);
+    else if (argument == "--slow-clients")
+      options.slow_clients = std::strtoul(argv[++index], nullptr, 10);
+    else if (argument == "--server-threads")
+      options.server_threads = std::strtoul(argv[++index], nullptr, 10);
+    else if (argument == "--event-loops")
+      options.event_loops = std::strtoul(argv[++index], nullptr, 10);
+    else if (argument == "--port")
+      options.port = std::atoi(argv[++index]);
+    else if (argument == "--save")
+      options.save = argv[++index];
+    else if (argument == "--baseline")
+      options.baseline = argv[++index];
+    else if (std::find(std::begin(scenario_names), std::end(scenario_names),
+                       argument) != std::end(scenario_names))
+      options.scenarios.push_back(argument);
+    else if (argument != "all")
+      return false;
+  }
+
+  if (options.scenarios.empty())
+    options.scenarios.assign(std::begin(scenario_names),
+                             std::end(scenario_names));
+
+  return options.rate > 0 && options.duration > 0 && options.warmup >= 0 &&
+         options.threads > 0 && options.connections >= options.threads &&
+         options.server_threads > 0;
+}
+
+int main(int argc, char **argv) {
+  BenchOptions options;
+  if (!parse_options(argc, argv, options)) {
+    usage();
+    return 1;
+  }
+
+  std::atomic<uint64_t> server_errors(0);
+  std::filesystem::path public_dir = create_public_dir();
+  std::unique_ptr<Weblet> server;
+
+  try {
+    server = start_server(options, public_dir.string(), server_errors);
+  } catch (const std::exception &e) {
+    std::cerr << "Could not start the benchmarked server: " << e.what()
+              << std::endl;
+    return 1;
+  }
+
+  std::map<std::string, BenchResult> baseline;
+  if (!options.baseline.empty())
+    baseline = load_results(options.baseline);
+
+  std::cout << "weblet_bench: " << options.connections << " connections, "
+            << options.threads << " client threads, pipeline "
+            << options.pipeline
+            << (options.keep_alive ? ", keep-alive" : ", no keep-alive")
+            << ", " << options.server_threads << " server threads, "
+            << options.event_loops << " event loop(s)"
+            << (options.io_uring ? " (io_uring)" : "") << "\n\n"
+            << std::left << std::setw(10) << "scenario" << std::right
+            << std::setw(10) << "rate" << std::setw(12) << "req/s"
+            << std::setw(10) << "p50" << std::setw(10) << "p90"
+            << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+            << std::setw(10) << "max" << std::setw(8) << "errors"
+            << std::endl;
+
+  std::vector<BenchResult> results;
+  for (const std::string &name : options.scenarios) {
+    BenchResult result = run_scenario(options, build_scenario(name, options));
+    print_result(result, options.rate);
+
+    auto previous = baseline.find(name);
+    if (previous != baseline.end())
+      std::cout << "  vs baseline: req/s "
+                << change(result.throughput, previous->second.throughput)
+                << ", p50 " << change(result.p50, previous->second.p50)
+                << ", p99 " << change(result.p99, previous->second.p99)
+                << ", p99.9 " << change(result.p999, previous->second.p999)
+                << std::endl;
+
+    results.push_back(result);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
+
+  if (server_errors > 0)
+    std::cout << "\nServer reported " << server_errors << " errors."
+              << std::endl;
+  if (!options.save.empty())
+    save_results(options.save, results);
+
+  server->stop();
+  std::filesystem::remove_all(public_dir);
+
+  return 0;
+}
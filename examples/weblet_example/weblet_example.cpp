@@ -36,12 +36,11 @@ Response handshake(DotEnv env, Request request,
   return response;
 }
 
-Response fetch_employee(DotEnv env, Request request,
-                        std::map<std::string, std::string> parameters) {
+Response fetch_employee(const RequestContext &context) {
   Response response;
   response.set_header("Content-Type", "application/json");
 
-  if (parameters.find("id") == parameters.end()) {
+  if (!context.params.has("id")) {
     response.contents = "{\"error\": \"No {id} found on the URL path\"}";
     response.status_code = 400;
 
@@ -49,7 +48,7 @@ Response fetch_employee(DotEnv env, Request request,
     return response;
   }
 
-  std::string employee_id = parameters["id"];
+  std::string employee_id(context.param("id"));
   response.contents =
       std::string("{\"employee_id\": \"") + employee_id +
       "\", \"name\": \"John Doe\", \"position\": \"Software Engineer\"}";
@@ -35,9 +35,11 @@
 #include <condition_variable>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <mutex>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace Purple::Concurrent {
 
@@ -77,6 +79,25 @@ private:
       send_ack; ///< Condition variable to acknowledge synchronous sends.
   std::atomic<int> get_wait_count{
       0}; ///< Number of receivers currently waiting.
+  std::vector<std::function<void()>>
+      ready_callbacks; ///< Asynchronous receivers waiting for a value.
+
+  /**
+   * @brief Calls (and forgets) the callbacks of the asynchronous receivers.
+   *
+   * Called with `mtx` held after a value was queued or the channel closed.
+   * Every receiver is woken up; those finding no value wait again.
+   */
+  void notify_ready() {
+    if (capacity == 0)
+      get_wait_count -= static_cast<int>(ready_callbacks.size());
+
+    std::vector<std::function<void()>> callbacks;
+    callbacks.swap(ready_callbacks);
+
+    for (std::function<void()> &callback : callbacks)
+      callback();
+  }
 
 public:
   /**
@@ -86,7 +107,7 @@ public:
    */
   explicit Channel(size_t cap = 0)
       : closed(false), capacity(cap), mtx(), data(), send_cond_var(),
-        receive_cond_var(), send_ack(), get_wait_count{0} {}
+        receive_cond_var(), send_ack(), get_wait_count{0}, ready_callbacks() {}
 
   /**
    * @brief Sends a value into the channel, blocking if necessary.
@@ -113,6 +134,8 @@ public:
       throw std::runtime_error("send on closed channel");
 
     data.push_back(value);
+    notify_ready();
+
     if (capacity == 0) {
       receive_cond_var.notify_one();
       send_ack.wait(lock, [this] { return closed || data.empty(); });
@@ -181,6 +204,7 @@ public:
     if (capacity == 0) {
       if (get_wait_count > 0) {
         data.push_back(value);
+        notify_ready();
         receive_cond_var.notify_one();
         send_ack.wait(lock, [this] { return closed || data.empty(); });
 
@@ -192,6 +216,7 @@ public:
 
     if (data.size() < capacity) {
       data.push_back(value);
+      notify_ready();
       receive_cond_var.notify_one();
 
       return true;
@@ -228,6 +253,41 @@ public:
     return false;
   }
 
+  /**
+   * @brief Registers a callback called once a value may be received, for
+   * receivers that must not block.
+   *
+   * The callback is called once, on the thread sending the next value or
+   * closing the channel, with the channel locked: it must not use the
+   * channel itself, only schedule a receive elsewhere. On a synchronous
+   * channel, the registered receiver counts as waiting for senders.
+   *
+   * @param callback Function to call.
+   * @return `true` if the callback was registered, `false` if a value is
+   * already available or the channel is closed (it is then not called).
+   */
+  bool notify_on_ready(std::function<void()> callback) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (closed || !data.empty())
+      return false;
+
+    if (capacity == 0) {
+      get_wait_count++;
+      send_cond_var.notify_one();
+    }
+
+    ready_callbacks.push_back(std::move(callback));
+    return true;
+  }
+
+  /**
+   * @brief Checks whether the channel has been closed.
+   */
+  bool is_closed() {
+    std::unique_lock<std::mutex> lock(mtx);
+    return closed;
+  }
+
   /**
    * @brief Closes the channel.
    *
@@ -243,6 +303,7 @@ public:
     if (closed)
       return;
     closed = true;
+    notify_ready();
 
     send_cond_var.notify_all();
     receive_cond_var.notify_all();
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file task.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides C++20 coroutine tasks running on a TaskletManager.
+ *
+ * A `Task<T>` is a lazy coroutine producing a `T`: it starts when awaited
+ * (or spawned) and resumes its awaiter when done. A `TaskScheduler` lets
+ * tasks wait for timers and channel values without blocking a thread: the
+ * suspended coroutine is resumed later as a tasklet on one of the workers.
+ */
+#ifndef PURPLE_CONCURRENT_TASK_HPP
+#define PURPLE_CONCURRENT_TASK_HPP
+
+#include <purple/concurrent/channel.hpp>
+#include <purple/concurrent/tasklet.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Purple::Concurrent {
+
+template <typename T = void> class Task;
+
+namespace Detail {
+
+/**
+ * @struct PromiseBase
+ * @brief State shared by the promises of every `Task` type.
+ */
+struct PromiseBase {
+  std::coroutine_handle<> continuation; ///< Coroutine awaiting the task.
+  std::exception_ptr error;             ///< Exception the task ended with.
+
+  /**
+   * @struct FinalAwaiter
+   * @brief Transfers control to the awaiting coroutine once a task is done.
+   */
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      std::coroutine_handle<> continuation = handle.promise().continuation;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  PromiseBase() : continuation(), error() {}
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() { this->error = std::current_exception(); }
+};
+
+/**
+ * @struct Promise
+ * @brief Promise of a `Task<T>`, holding the produced value.
+ */
+template <typename T> struct Promise : PromiseBase {
+  std::optional<T> value; ///< Value the task returned.
+
+  Promise() : PromiseBase(), value() {}
+
+  Task<T> get_return_object();
+
+  template <typename U> void return_value(U &&result) {
+    this->value.emplace(std::forward<U>(result));
+  }
+};
+
+/**
+ * @struct Promise<void>
+ * @brief Promise of a `Task<void>`.
+ */
+template <> struct Promise<void> : PromiseBase {
+  Task<void> get_return_object();
+  void return_void() const noexcept {}
+};
+
+} // namespace Detail
+
+/**
+ * @class Task
+ * @brief Lazily started coroutine producing a value of type `T`.
+ *
+ * A task is move-only and owns its coroutine frame. Awaiting it starts it
+ * and yields its value, or rethrows the exception it ended with.
+ *
+ * @tparam T Type of the produced value, or `void`.
+ */
+template <typename T> class Task {
+public:
+  using promise_type = Detail::Promise<T>; ///< Coroutine promise type.
+
+private:
+  std::coroutine_handle<promise_type> handle; ///< Owned coroutine frame.
+
+public:
+  /**
+   * @brief Takes ownership of a coroutine frame (used by the promise).
+   */
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+  Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      if (this->handle)
+        this->handle.destroy();
+
+      this->handle = std::exchange(other.handle, nullptr);
+    }
+
+    return *this;
+  }
+
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+
+  /**
+   * @brief Destroys the coroutine frame, if still owned.
+   */
+  ~Task() {
+    if (this->handle)
+      this->handle.destroy();
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> awaiting) noexcept {
+    this->handle.promise().continuation = awaiting;
+    return this->handle;
+  }
+
+  T await_resume() {
+    promise_type &promise = this->handle.promise();
+    if (promise.error)
+      std::rethrow_exception(promise.error);
+
+    if constexpr (!std::is_void_v<T>)
+      return std::move(*promise.value);
+  }
+};
+
+template <typename T> Task<T> Detail::Promise<T>::get_return_object() {
+  return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Detail::Promise<void>::get_return_object() {
+  return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+/**
+ * @struct Detached
+ * @brief Eagerly started coroutine nobody awaits, used by spawn().
+ */
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+/**
+ * @brief Starts a task on the current thread and calls `done` when it ends.
+ *
+ * The task runs until its first suspension before spawn() returns, and
+ * `done` is called on whichever thread finishes it: with the produced value
+ * (empty on error) and the exception, or only the exception for
+ * `Task<void>`. `done` must not throw.
+ *
+ * @param task Task to run.
+ * @param done Completion callback.
+ */
+template <typename T, typename Done> Detached spawn(Task<T> task, Done done) {
+  std::exception_ptr error;
+
+  if constexpr (std::is_void_v<T>) {
+    try {
+      co_await task;
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    done(error);
+  } else {
+    std::optional<T> value;
+
+    try {
+      value.emplace(co_await task);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    done(std::move(value), error);
+  }
+}
+
+/**
+ * @class TaskScheduler
+ * @brief Resumes suspended tasks on the workers of a TaskletManager.
+ *
+ * Timers are kept by a single thread, started on the first sleep, which only
+ * hands expired coroutines over to the workers. Once the scheduler is
+ * stopped, coroutines still waiting for a timer or a channel are never
+ * resumed and their frames are abandoned; start() makes it usable again.
+ */
+class TaskScheduler {
+private:
+  using Clock = std::chrono::steady_clock; ///< Clock of the timers.
+
+  /**
+   * @struct State
+   * @brief Scheduler state, shared with the callbacks left on channels so
+   * that they stay safe to call after the scheduler is gone.
+   */
+  struct State {
+    TaskletManager *workers;           ///< Workers resuming coroutines.
+    std::mutex mutex;                  ///< Guards the fields below.
+    std::condition_variable condition; ///< Signals timers and stop.
+    std::multimap<Clock::time_point, std::coroutine_handle<>>
+        timers;   ///< Sleeping coroutines by wake-up time.
+    bool stopped; ///< Set once the scheduler stops.
+
+    explicit State(TaskletManager *workers)
+        : workers(workers), mutex(), condition(), timers(), stopped(false) {}
+
+    State(const State &) = delete;
+    State &operator=(const State &) = delete;
+  };
+
+  /**
+   * @struct SleepAwaiter
+   * @brief Awaiter suspending a task for a duration.
+   */
+  struct SleepAwaiter {
+    TaskScheduler &scheduler; ///< Scheduler keeping the timer.
+    Clock::duration delay;    ///< Time to sleep.
+
+    bool await_ready() const noexcept {
+      return this->delay <= Clock::duration::zero();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      this->scheduler.resume_after(this->delay, handle);
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  /**
+   * @struct ReadyAwaiter
+   * @brief Awaiter suspending a task until a channel may have a value.
+   */
+  template <typename T> struct ReadyAwaiter {
+    std::shared_ptr<State> state; ///< Scheduler resuming the task.
+    Channel<T> &channel;          ///< Awaited channel.
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      return this->channel.notify_on_ready([state = this->state, handle] {
+        TaskScheduler::resume(state, handle);
+      });
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  std::shared_ptr<State> state; ///< Shared scheduler state.
+  bool timer_started;           ///< `timer_thread` runs (guarded by state).
+  std::thread timer_thread;     ///< Thread waking up sleeping coroutines.
+
+  static void resume(const std::shared_ptr<State> &state,
+                     std::coroutine_handle<> handle);
+  static void run_timers(std::shared_ptr<State> state);
+
+public:
+  /**
+   * @brief Constructs a scheduler resuming tasks on the given workers.
+   * @param workers Tasklet manager, which must outlive the scheduler.
+   */
+  explicit TaskScheduler(TaskletManager &workers);
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  /**
+   * @brief Stops the scheduler.
+   */
+  ~TaskScheduler();
+
+  /**
+   * @brief Schedules a suspended coroutine to resume on a worker.
+   * @param handle Coroutine to resume.
+   */
+  void resume(std::coroutine_handle<> handle);
+
+  /**
+   * @brief Schedules a suspended coroutine to resume after a delay.
+   * @param delay Time to wait before resuming it.
+   * @param handle Coroutine to resume.
+   */
+  void resume_after(Clock::duration delay, std::coroutine_handle<> handle);
+
+  /**
+   * @brief Returns an awaiter suspending the awaiting task for a duration,
+   * without blocking its thread.
+   * @param delay Time to sleep.
+   */
+  template <typename Rep, typename Period>
+  SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> delay) {
+    return SleepAwaiter{
+        *this, std::chrono::ceil<Clock::duration>(delay)};
+  }
+
+  /**
+   * @brief Receives a value from a channel without blocking a thread.
+   *
+   * @param channel Channel to receive from; it must outlive the task.
+   * @return The value and `true`, or a default value and `false` once the
+   * channel is closed and drained.
+   */
+  template <typename T>
+  Task<std::pair<T, bool>> receive(Channel<T> &channel) {
+    while (true) {
+      T value;
+
+      if (channel.try_receive(value))
+        co_return std::pair<T, bool>(std::move(value), true);
+      else if (channel.is_closed()) {
+        if (channel.try_receive(value))
+          co_return std::pair<T, bool>(std::move(value), true);
+
+        co_return std::pair<T, bool>(T(), false);
+      }
+
+      co_await ReadyAwaiter<T>{this->state, channel};
+    }
+  }
+
+  /**
+   * @brief Restarts a stopped scheduler.
+   *
+   * Coroutines abandoned by the previous stop() stay abandoned. Must not be
+   * called while tasks are running.
+   */
+  void start();
+
+  /**
+   * @brief Stops resuming coroutines and joins the timer thread.
+   */
+  void stop();
+};
+
+} // namespace Purple::Concurrent
+
+#endif
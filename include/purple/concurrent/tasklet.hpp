@@ -126,6 +126,24 @@ public:
    */
   void go(std::function<void()> task);
 
+  /**
+   * @brief Schedules a task unless the queue is already full.
+   *
+   * Unlike go(), which always queues, the task is rejected when at least
+   * `max_queued` tasks are waiting for a worker, so that callers can shed
+   * load instead of letting the queue grow without bound.
+   *
+   * @param task Function object representing the task to execute.
+   * @param max_queued Maximum number of waiting tasks; `0` means unbounded.
+   * @return true if the task was queued, false if it was rejected.
+   */
+  bool try_go(std::function<void()> task, size_t max_queued);
+
+  /**
+   * @brief Returns the number of tasks waiting for a worker thread.
+   */
+  size_t queued_tasks();
+
   /**
    * @brief Waits until all scheduled tasks have completed execution.
    *
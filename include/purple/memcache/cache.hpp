@@ -479,8 +479,9 @@ public:
 
     auto it = cache_map.find(key);
     if (it != cache_map.end()) {
-      lru_list.erase(it->second);
       stats.current_size_bytes -= it->second->second.size_bytes;
+      stats.current_item_count--;
+      lru_list.erase(it->second);
     }
 
     lru_list.emplace_front(
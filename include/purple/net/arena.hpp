@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file arena.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the bump-pointer arena backing the memory of a request.
+ *
+ * Header storage and handler scratch containers of a request are allocated
+ * from its arena with `std::pmr` allocators. Allocating is a pointer bump,
+ * nothing is freed individually, and the whole arena is released in one go
+ * together with the request once its response has been produced.
+ */
+#ifndef PURPLE_NET_ARENA_HPP
+#define PURPLE_NET_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_ARENA_BLOCK_SIZE
+ * @brief Size of the first block of a request arena (4 KB); larger requests
+ * grow the arena with blocks taken from the default memory resource.
+ */
+#define WEBLET_ARENA_BLOCK_SIZE 4096
+
+/**
+ * @class RequestArena
+ * @brief Monotonic memory resource owned by a single request.
+ *
+ * Moving an arena hands its memory over to the destination, so containers
+ * allocated from it stay valid after the request is moved. Copies do not
+ * share memory: a copied arena is empty and allocates from the default
+ * resource, matching `std::pmr` containers, which do not propagate their
+ * allocator on copy. Assigning to an arena keeps its own memory for the same
+ * reason.
+ */
+class RequestArena {
+private:
+  /**
+   * @struct Block
+   * @brief First arena block, allocated together with its resource.
+   */
+  struct Block {
+    alignas(std::max_align_t) char buffer[WEBLET_ARENA_BLOCK_SIZE]; ///< Data.
+    std::pmr::monotonic_buffer_resource resource; ///< Bump allocator.
+
+    Block() : buffer(), resource(buffer, sizeof(buffer)) {}
+  };
+
+  std::unique_ptr<Block> block; ///< Arena memory (null once moved from).
+
+public:
+  /**
+   * @brief Constructs an arena with a fresh first block.
+   */
+  RequestArena();
+
+  /**
+   * @brief Constructs an empty arena allocating from the default resource.
+   */
+  RequestArena(const RequestArena &);
+
+  /**
+   * @brief Takes over the memory of another arena.
+   */
+  RequestArena(RequestArena &&other) noexcept = default;
+
+  /**
+   * @brief Keeps the memory of this arena; nothing is shared or released.
+   */
+  RequestArena &operator=(const RequestArena &);
+
+  /**
+   * @brief Keeps the memory of this arena; nothing is shared or released.
+   */
+  RequestArena &operator=(RequestArena &&) noexcept;
+
+  /**
+   * @brief Returns the memory resource to allocate from.
+   *
+   * Memory allocated from it lives as long as the arena (or the arena it is
+   * moved into).
+   */
+  std::pmr::memory_resource *resource() const;
+};
+
+} // namespace Purple::Net
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file compression.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the zlib based content codings of Weblet responses.
+ *
+ * Each thread keeps one deflate state per coding and resets it between
+ * bodies, so compressing a response costs no allocation inside zlib.
+ */
+#ifndef PURPLE_NET_COMPRESSION_HPP
+#define PURPLE_NET_COMPRESSION_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <zlib.h>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_COMPRESSION_MIN_SIZE
+ * @brief Default size below which bodies are sent uncompressed (1 KB).
+ */
+#define WEBLET_COMPRESSION_MIN_SIZE 1024
+
+/**
+ * @def WEBLET_COMPRESSION_LEVEL
+ * @brief Default zlib level of dynamically compressed responses (6).
+ */
+#define WEBLET_COMPRESSION_LEVEL 6
+
+/**
+ * @def WEBLET_COMPRESSION_MAX_STATIC
+ * @brief Largest static asset compressed in memory when it has no `.gz`
+ * sibling (8 MB).
+ */
+#define WEBLET_COMPRESSION_MAX_STATIC 8388608
+
+/**
+ * @enum ContentCoding
+ * @brief Content codings Weblet can apply to a response body.
+ */
+enum class ContentCoding {
+  Identity, ///< Sent as is.
+  Gzip,     ///< `gzip` (RFC 1952).
+  Deflate   ///< `deflate`, i.e. the zlib format (RFC 1950).
+};
+
+/**
+ * @class Compressor
+ * @brief Reusable deflate state producing one content coding.
+ */
+class Compressor {
+private:
+  z_stream stream;      ///< zlib deflate state.
+  ContentCoding coding; ///< Coding produced.
+  int level;            ///< Compression level of `stream`.
+  bool initialized;     ///< `stream` has been initialized.
+
+public:
+  /**
+   * @brief Constructs a compressor; zlib is initialized on first use.
+   * @param content_coding Gzip or Deflate.
+   */
+  explicit Compressor(ContentCoding content_coding);
+
+  Compressor(const Compressor &) = delete;
+  Compressor &operator=(const Compressor &) = delete;
+
+  /**
+   * @brief Releases the deflate state.
+   */
+  ~Compressor();
+
+  /**
+   * @brief Compresses a whole body.
+   * @param input Body to compress.
+   * @param compression_level zlib level (1-9).
+   * @param output Receives the encoded body.
+   * @return false if zlib failed or the result is not smaller than `input`.
+   */
+  bool compress(std::string_view input, int compression_level,
+                std::string &output);
+};
+
+/**
+ * @brief Compresses a body with the calling thread's compressor.
+ * @param coding Gzip or Deflate.
+ * @param input Body to compress.
+ * @param level zlib level (1-9).
+ * @param output Receives the encoded body.
+ * @return false if the body should be sent uncompressed.
+ */
+bool compress_body(ContentCoding coding, std::string_view input, int level,
+                   std::string &output);
+
+/**
+ * @brief Picks the coding preferred by an `Accept-Encoding` header.
+ *
+ * Honors quality values; gzip wins ties. A missing header (empty value)
+ * selects Identity.
+ */
+ContentCoding negotiate_coding(std::string_view accept_encoding);
+
+/**
+ * @brief Returns the `Content-Encoding` token of a coding.
+ */
+const char *coding_name(ContentCoding coding);
+
+/**
+ * @brief Checks whether a media type is worth compressing (text, JSON,
+ * JavaScript, XML, SVG and similar).
+ */
+bool is_compressible_type(std::string_view content_type);
+
+} // namespace Purple::Net
+
+#endif
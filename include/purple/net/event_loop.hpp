@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file event_loop.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the connection and event loop state used by the Weblet
+ * epoll reactor.
+ *
+ * An event loop owns a listening socket, an edge-triggered epoll instance and
+ * every client connection accepted from it. Socket I/O only ever happens on
+ * the loop thread; request handlers run on tasklet workers and hand their
+ * serialized responses back through a completion queue and an `eventfd`
+ * wake-up.
+ */
+#ifndef PURPLE_NET_EVENT_LOOP_HPP
+#define PURPLE_NET_EVENT_LOOP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <purple/net/http_parser.hpp>
+#include <purple/net/io_uring.hpp>
+#include <purple/net/sse.hpp>
+#include <purple/net/timer_wheel.hpp>
+#include <purple/net/websocket.hpp>
+
+namespace Purple::Net {
+
+struct ResponseFile;
+struct ResponseStream;
+struct BodyReceiver;
+
+/**
+ * @struct PendingResponse
+ * @brief Response slot of a request dispatched on a persistent connection.
+ *
+ * Slots are queued in request order so that pipelined responses are written
+ * in the order their requests arrived, whichever worker finishes first.
+ */
+struct PendingResponse {
+  bool ready;                         ///< The worker produced the response.
+  bool keep_alive;                    ///< The connection stays open after it.
+  std::string head;                   ///< Status line and header block.
+  std::string body;                   ///< In-memory body sent after `head`.
+  std::shared_ptr<ResponseFile> file; ///< File body sent after `body`.
+  std::shared_ptr<ResponseStream>
+      stream;   ///< Streamed body produced after `head`.
+  size_t route; ///< Metrics slot of the route of the request.
+};
+
+/**
+ * @struct PhaseTrace
+ * @brief Start times of the request phases timed on the event loop, kept
+ * per connection while metrics are enabled.
+ */
+struct PhaseTrace {
+  long long head_started; ///< First bytes of the current head (ns), or 0.
+  long long body_started; ///< End of the head whose body is read (ns).
+  size_t route;           ///< Metrics slot of the request being read.
+  long long send_started; ///< First response of the write burst (ns), or 0.
+  size_t send_route;      ///< Metrics slot of that response.
+};
+
+/**
+ * @struct OutputSegment
+ * @brief A buffer queued for writing to a connection.
+ *
+ * Segments normally own their bytes; broadcast WebSocket frames and SSE
+ * events are instead shared by every connection they are queued to.
+ */
+struct OutputSegment {
+  std::string owned;                         ///< Owned bytes.
+  std::shared_ptr<const std::string> shared; ///< Shared bytes, if set.
+
+  /**
+   * @brief Constructs a segment owning its bytes.
+   */
+  OutputSegment(std::string bytes) : owned(std::move(bytes)), shared() {}
+
+  /**
+   * @brief Constructs a segment sharing its bytes.
+   */
+  OutputSegment(std::shared_ptr<const std::string> bytes)
+      : owned(), shared(std::move(bytes)) {}
+
+  /**
+   * @brief Returns the first byte of the segment.
+   */
+  const char *data() const {
+    return this->shared ? this->shared->data() : this->owned.data();
+  }
+
+  /**
+   * @brief Returns the number of bytes of the segment.
+   */
+  size_t size() const {
+    return this->shared ? this->shared->size() : this->owned.size();
+  }
+};
+
+/**
+ * @struct Connection
+ * @brief Per-client state of a socket accepted by an event loop.
+ *
+ * Holds the bytes received but not yet consumed by the request parser, the
+ * state of a request body still being received, the responses of in-flight
+ * requests and the response segments (heads and bodies, kept as separate
+ * buffers) that still have to be written. Once upgraded to a WebSocket,
+ * `input` holds frames instead; once subscribed to an event stream, input is
+ * discarded. The socket is closed when the connection is
+ * destroyed.
+ */
+struct Connection {
+  int fd;      ///< Non-blocking client socket descriptor.
+  uint64_t id; ///< Loop-unique identifier, guards against descriptor reuse.
+
+  sockaddr_storage peer;      ///< Peer address (AF_UNSPEC if unknown).
+  std::string remote_address; ///< Peer IP address, see peer_address().
+
+  std::string input;              ///< Received bytes not yet consumed.
+  HttpParser parser;              ///< Parser of the request head at `input`.
+  std::unique_ptr<BodyReceiver>
+      body; ///< Request whose body is being received (if any).
+  std::deque<OutputSegment> output; ///< Response segments pending write.
+  size_t output_offset; ///< Bytes of `output.front()` already written.
+  std::shared_ptr<ResponseFile>
+      output_file;       ///< File body sent once `output` is written.
+  off_t file_offset;     ///< Offset of the next file byte to send.
+  size_t file_remaining; ///< Number of file bytes left to send.
+  std::shared_ptr<ResponseStream>
+      output_stream; ///< Streamed body produced once `output` drains.
+
+  std::deque<PendingResponse> pending; ///< In-flight responses, in order.
+  uint64_t first_sequence;             ///< Sequence of `pending.front()`.
+  std::unique_ptr<WebSocketSession>
+      websocket; ///< WebSocket state once the connection is upgraded.
+  std::shared_ptr<SsePublisher>
+      event_stream; ///< Publisher the connection is subscribed to, if any.
+
+  bool close_after_write;    ///< Close once every response is written.
+  long long last_active;     ///< Monotonic time (ms) of the last activity.
+  long long request_started; ///< Time (ms) the current head began, or 0.
+  long long timer_deadline;  ///< Deadline of the armed timer, or 0.
+  PhaseTrace trace;          ///< Phase timings, when metrics are enabled.
+
+  unsigned ops_in_flight;      ///< io_uring requests still in flight.
+  bool closing;                ///< Shut down, destroyed once idle.
+  bool receiving;              ///< A read or readability poll is in flight.
+  bool awaiting_buffer;        ///< Queued for a free receive buffer.
+  bool read_paused;            ///< Not read until its pipeline drains.
+  bool sending;                ///< A send or writability poll is in flight.
+  int receive_buffer;          ///< Buffer of the in-flight read, or -1.
+  std::vector<iovec> send_iov; ///< Segments of the in-flight send.
+  msghdr send_message;         ///< Message of the in-flight send.
+
+  /**
+   * @brief Constructs the state for a freshly accepted client socket.
+   * @param descriptor Client socket descriptor (owned by the connection).
+   * @param identifier Loop-unique connection identifier.
+   * @param now Monotonic time (ms) at which the socket was accepted.
+   */
+  Connection(int descriptor, uint64_t identifier, long long now);
+
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+
+  /**
+   * @brief Destructor closes the client socket.
+   */
+  ~Connection();
+
+  /**
+   * @brief Returns the IP address of the peer, formatted on first use.
+   *
+   * The address reported by accept is used when available; otherwise it is
+   * queried from the socket.
+   */
+  const std::string &peer_address();
+};
+
+/**
+ * @struct Completion
+ * @brief A serialized response produced by a worker for a connection.
+ *
+ * When `chunk` is set the completion instead carries the next piece of the
+ * body of `stream`, framed and split into `head` and `body`.
+ */
+struct Completion {
+  uint64_t connection_id;             ///< Identifier of the connection.
+  int fd;                             ///< Descriptor of the connection.
+  uint64_t sequence;                  ///< Sequence number of the request.
+  bool keep_alive;                    ///< The connection may persist.
+  std::string head;                   ///< Status line and header block.
+  std::string body;                   ///< In-memory body sent after `head`.
+  std::shared_ptr<ResponseFile> file; ///< File body sent after `body`.
+  std::shared_ptr<ResponseStream>
+      stream; ///< Streamed body produced after `head`.
+  bool chunk; ///< Carries a piece of `stream` rather than a response.
+};
+
+/**
+ * @struct EventLoop
+ * @brief State of a single epoll reactor.
+ *
+ * The loop thread is the only one touching `connections`; workers only ever
+ * call post(), which queues a completion and wakes the loop up.
+ *
+ * A loop is driven either by epoll readiness events or, when `ring` is set,
+ * by io_uring completions. In the latter case reads land in a pool of
+ * receive buffers registered with the ring.
+ */
+struct EventLoop {
+  int listen_desc; ///< Listening socket descriptor.
+  int epoll_desc;  ///< Epoll instance descriptor.
+  int wake_desc;   ///< `eventfd` used to wake the loop from other threads.
+
+  uint64_t next_connection_id; ///< Next connection identifier to hand out.
+  TimerWheel timers;           ///< Connection timeouts.
+  std::unordered_map<int, std::unique_ptr<Connection>>
+      connections; ///< Open connections keyed by descriptor.
+
+  std::mutex completions_mutex;        ///< Protects the two queues below.
+  std::vector<Completion> completions; ///< Responses awaiting write.
+  std::vector<FrameDelivery> frames;   ///< Shared frames awaiting write.
+
+  std::unique_ptr<IoUring> ring;      ///< io_uring instance (null with epoll).
+  bool multishot_accept;              ///< Multishot accept is supported.
+  bool buffers_registered;            ///< `receive_buffers` are registered.
+  std::vector<char> receive_buffers;  ///< Pool of receive buffers.
+  std::vector<unsigned> free_buffers; ///< Indices of unused buffers.
+  std::deque<int> buffer_waiters;     ///< Connections waiting for a buffer.
+  sockaddr_storage accept_address;    ///< Peer of the single-shot accept.
+  socklen_t accept_address_length;    ///< Size of `accept_address`.
+
+  /**
+   * @brief Constructs an event loop with no descriptors attached yet.
+   */
+  EventLoop()
+      : listen_desc(-1), epoll_desc(-1), wake_desc(-1), next_connection_id(1),
+        timers(), connections(), completions_mutex(), completions(),
+        frames(), ring(), multishot_accept(true), buffers_registered(false),
+        receive_buffers(), free_buffers(), buffer_waiters(), accept_address(),
+        accept_address_length(sizeof(sockaddr_storage)) {}
+
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+
+  /**
+   * @brief Destructor closes every connection and loop descriptor.
+   */
+  ~EventLoop();
+
+  /**
+   * @brief Queues a completed response and wakes the loop up.
+   *
+   * Safe to call from any thread.
+   *
+   * @param completion The response to deliver.
+   */
+  void post(Completion completion);
+
+  /**
+   * @brief Atomically takes every queued completion.
+   * @return The completions queued since the last call.
+   */
+  std::vector<Completion> take_completions();
+
+  /**
+   * @brief Queues a WebSocket frame or SSE event and wakes the loop up.
+   *
+   * Safe to call from any thread.
+   *
+   * @param delivery The frame and the connections to queue it to.
+   */
+  void post_frames(FrameDelivery delivery);
+
+  /**
+   * @brief Atomically takes every queued frame delivery.
+   * @return The deliveries queued since the last call.
+   */
+  std::vector<FrameDelivery> take_frames();
+
+  /**
+   * @brief Wakes the loop thread up from `epoll_wait()`.
+   */
+  void wake();
+
+  /**
+   * @brief Resets the wake-up counter after the loop has been woken up.
+   */
+  void drain_wake();
+};
+
+/**
+ * @brief Returns the current monotonic time in milliseconds.
+ *
+ * Used for connection activity tracking, unaffected by wall clock changes.
+ */
+long long monotonic_ms();
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ *
+ * Used to time the phases of requests when metrics are enabled.
+ */
+long long monotonic_ns();
+
+} // namespace Purple::Net
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file http_parser.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the incremental, zero-copy HTTP/1.x request head parser
+ * used by Weblet.
+ *
+ * The parser works directly on a connection's receive buffer. It can be fed
+ * the same (growing) buffer after every read and resumes at the line where it
+ * stopped, so partial reads never cause the head to be rescanned. Parsed
+ * fields are exposed as string views into the buffer; no allocation happens
+ * while parsing.
+ */
+#ifndef PURPLE_NET_HTTP_PARSER_HPP
+#define PURPLE_NET_HTTP_PARSER_HPP
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_MAX_HEADER_SIZE
+ * @brief Maximum size in bytes of a request line plus headers (16 KB).
+ *
+ * Clients exceeding it without terminating their headers receive a 400.
+ */
+#define WEBLET_MAX_HEADER_SIZE 16384
+
+/**
+ * @def WEBLET_MAX_HEADERS
+ * @brief Maximum number of header fields in a request head (64).
+ */
+#define WEBLET_MAX_HEADERS 64
+
+/**
+ * @brief Compares two strings for equality, ignoring ASCII case.
+ * @param left First string.
+ * @param right Second string.
+ * @return true if both strings are equal regardless of case.
+ */
+bool iequals(std::string_view left, std::string_view right);
+
+/**
+ * @struct CaseInsensitiveLess
+ * @brief Transparent ASCII case-insensitive ordering for header names.
+ */
+struct CaseInsensitiveLess {
+  using is_transparent = void; ///< Enables heterogeneous lookups.
+
+  /**
+   * @brief Returns whether `left` sorts before `right`, ignoring case.
+   */
+  bool operator()(std::string_view left, std::string_view right) const;
+};
+
+/**
+ * @typedef HeaderMap
+ * @brief Map of header fields with case-insensitive names.
+ *
+ * Nodes, names and values are allocated from the map's memory resource,
+ * which for request headers is the arena of the request.
+ */
+using HeaderMap =
+    std::pmr::map<std::pmr::string, std::pmr::string, CaseInsensitiveLess>;
+
+/**
+ * @struct HttpHeader
+ * @brief A header field of a parsed request head.
+ */
+struct HttpHeader {
+  std::string_view name;  ///< Field name as sent by the client.
+  std::string_view value; ///< Field value without surrounding whitespace.
+
+  /**
+   * @brief Constructs an empty header field.
+   */
+  HttpHeader() : name(), value() {}
+
+  /**
+   * @brief Constructs a header field from its name and value.
+   * @param field_name Field name.
+   * @param field_value Field value.
+   */
+  HttpHeader(std::string_view field_name, std::string_view field_value)
+      : name(field_name), value(field_value) {}
+};
+
+/**
+ * @struct HttpRequestHead
+ * @brief Request line and header fields of a parsed request.
+ *
+ * Every field is a view into the buffer given to HttpParser::parse() and is
+ * only valid until that buffer is modified.
+ */
+struct HttpRequestHead {
+  std::string_view method;  ///< Request method (e.g. `GET`).
+  std::string_view target;  ///< Request target (path and query).
+  std::string_view path;    ///< Path component of the target.
+  std::string_view query;   ///< Query component, without the `?`.
+  std::string_view version; ///< Protocol version (e.g. `HTTP/1.1`).
+
+  std::array<HttpHeader, WEBLET_MAX_HEADERS> headers; ///< Header fields.
+  size_t header_count; ///< Number of valid entries in `headers`.
+
+  /**
+   * @brief Constructs an empty request head.
+   */
+  HttpRequestHead()
+      : method(), target(), path(), query(), version(), headers(),
+        header_count(0) {}
+
+  /**
+   * @brief Looks a header field up by name, ignoring case.
+   * @param name Field name.
+   * @return The first field with that name, or null if absent.
+   */
+  const HttpHeader *find(std::string_view name) const;
+
+  /**
+   * @brief Returns the value of a header field, ignoring name case.
+   * @param name Field name.
+   * @return The field value, or an empty view if absent.
+   */
+  std::string_view header(std::string_view name) const;
+};
+
+/**
+ * @enum HttpParseStatus
+ * @brief Outcome of feeding a buffer to the parser.
+ */
+enum class HttpParseStatus {
+  Incomplete, ///< More bytes are needed to finish the head.
+  Complete,   ///< The head has been parsed; see HttpParser::head().
+  Error       ///< The head is malformed; see HttpParser::error().
+};
+
+/**
+ * @class HttpParser
+ * @brief Resumable state machine parsing HTTP/1.x request heads.
+ *
+ * Internally only offsets are kept while the head is incomplete, so the
+ * buffer may be reallocated between calls as long as its already parsed
+ * prefix is left untouched.
+ */
+class HttpParser {
+private:
+  /**
+   * @enum State
+   * @brief Position of the parser within the request head.
+   */
+  enum class State { RequestLine, HeaderLine, Complete, Error };
+
+  /**
+   * @struct Span
+   * @brief Offset and length of a parsed field within the buffer.
+   */
+  struct Span {
+    size_t offset; ///< Offset of the first byte.
+    size_t length; ///< Number of bytes.
+  };
+
+  State state;               ///< Current parser state.
+  size_t line_start;         ///< Offset of the line being parsed.
+  size_t scanned;            ///< Offset up to which no line end was found.
+  const char *error_message; ///< Description of the parse error.
+
+  Span method;  ///< Request method.
+  Span target;  ///< Request target.
+  Span version; ///< Protocol version.
+  std::array<std::pair<Span, Span>, WEBLET_MAX_HEADERS>
+      fields;         ///< Name and value of each header field.
+  size_t field_count; ///< Number of parsed fields.
+
+  HttpRequestHead parsed; ///< Views built once the head is complete.
+
+  bool parse_request_line(std::string_view line, size_t offset);
+  bool parse_header_line(std::string_view line, size_t offset);
+  bool check_framing();
+  void fail(const char *message);
+
+public:
+  /**
+   * @brief Constructs a parser awaiting a request line.
+   */
+  HttpParser()
+      : state(State::RequestLine), line_start(0), scanned(0),
+        error_message(""), method(), target(), version(), fields(),
+        field_count(0), parsed() {}
+
+  /**
+   * @brief Parses as much of the request head as is available.
+   *
+   * Has to be called with the same buffer (possibly extended) until it
+   * returns something other than HttpParseStatus::Incomplete. A head whose
+   * body length is ambiguous (differing Content-Length fields, or both
+   * Transfer-Encoding and Content-Length) is rejected as malformed.
+   *
+   * @param buffer Received bytes, starting at the request line.
+   * @return The parse status.
+   */
+  HttpParseStatus parse(std::string_view buffer);
+
+  /**
+   * @brief Returns the parsed head once parse() reported completion.
+   */
+  const HttpRequestHead &head() const;
+
+  /**
+   * @brief Returns the number of buffer bytes taken by the head, including
+   * the terminating empty line.
+   */
+  size_t head_length() const;
+
+  /**
+   * @brief Returns a description of the error once parse() failed.
+   */
+  const char *error() const;
+
+  /**
+   * @brief Resets the parser for the next request on the connection.
+   */
+  void reset();
+};
+
+} // namespace Purple::Net
+
+#endif
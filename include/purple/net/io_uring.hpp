@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file io_uring.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides a minimal io_uring submission/completion ring used by the
+ * io_uring backend of Weblet.
+ *
+ * The ring is driven through the raw `io_uring_setup()`, `io_uring_enter()`
+ * and `io_uring_register()` system calls, so neither liburing nor its
+ * headers are needed. When the kernel headers lack io_uring, or the running
+ * kernel does not support it, setup() fails and callers are expected to
+ * fall back to epoll.
+ */
+#ifndef PURPLE_NET_IO_URING_HPP
+#define PURPLE_NET_IO_URING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace Purple::Net {
+
+/**
+ * @struct IoUringCompletion
+ * @brief A completion reaped from the ring.
+ */
+struct IoUringCompletion {
+  uint64_t user_data; ///< Value the request was submitted with.
+  int32_t result;     ///< Result of the operation, or `-errno`.
+  bool more;          ///< A multishot request will complete again.
+};
+
+/**
+ * @class IoUring
+ * @brief Submission and completion queues of one io_uring instance.
+ *
+ * Requests are prepared with the `prepare_*` functions and handed to the
+ * kernel in batches by submit_and_wait(). The object is not thread-safe; it
+ * is meant to be owned and driven by a single event loop thread.
+ */
+class IoUring {
+private:
+  int ring_desc; ///< io_uring instance descriptor (-1 if not set up).
+
+  void *sq_ring;       ///< Mapped submission queue ring.
+  size_t sq_ring_size; ///< Size of the `sq_ring` mapping.
+  void *cq_ring;       ///< Mapped completion queue ring.
+  size_t cq_ring_size; ///< Size of the `cq_ring` mapping.
+  void *sqes;          ///< Mapped submission queue entries.
+  size_t sqes_size;    ///< Size of the `sqes` mapping.
+
+  unsigned *sq_tail;  ///< Submission queue tail (written by us).
+  unsigned *sq_mask;  ///< Submission queue index mask.
+  unsigned *sq_array; ///< Submission queue index array.
+  unsigned *cq_head;  ///< Completion queue head (written by us).
+  unsigned *cq_tail;  ///< Completion queue tail (written by the kernel).
+  unsigned *cq_mask;  ///< Completion queue index mask.
+  void *cqes;         ///< Completion queue entries.
+
+  unsigned sq_entries;     ///< Number of submission queue entries.
+  unsigned queued;         ///< Prepared requests not yet submitted.
+  int64_t timeout_spec[2]; ///< Seconds and nanoseconds of the last timeout.
+
+  void *next_entry(uint8_t opcode, int fd, uint64_t user_data);
+  int enter(unsigned wait_count);
+
+public:
+  /**
+   * @brief Constructs a ring that has not been set up yet.
+   */
+  IoUring()
+      : ring_desc(-1), sq_ring(nullptr), sq_ring_size(0), cq_ring(nullptr),
+        cq_ring_size(0), sqes(nullptr), sqes_size(0), sq_tail(nullptr),
+        sq_mask(nullptr), sq_array(nullptr), cq_head(nullptr),
+        cq_tail(nullptr), cq_mask(nullptr), cqes(nullptr), sq_entries(0),
+        queued(0), timeout_spec() {}
+
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+
+  /**
+   * @brief Destructor unmaps the rings and closes the instance.
+   */
+  ~IoUring();
+
+  /**
+   * @brief Creates the io_uring instance and maps its queues.
+   * @param entries Number of submission queue entries.
+   * @return false if io_uring is unsupported or could not be set up.
+   */
+  bool setup(unsigned entries);
+
+  /**
+   * @brief Registers fixed buffers for prepare_read_fixed().
+   * @param buffers Buffers to register.
+   * @param count Number of buffers.
+   * @return false if registration failed.
+   */
+  bool register_buffers(const struct iovec *buffers, unsigned count);
+
+  /**
+   * @brief Prepares an accept that completes once per accepted client.
+   *
+   * On kernels without multishot accept the request fails with `-EINVAL`
+   * and has to be replaced with prepare_accept().
+   *
+   * @param fd Listening socket descriptor.
+   * @param user_data Value reported with every completion.
+   */
+  void prepare_accept_multishot(int fd, uint64_t user_data);
+
+  /**
+   * @brief Prepares an accept of a single client.
+   * @param fd Listening socket descriptor.
+   * @param address Receives the peer address.
+   * @param length Size of `address`, set to the size of the peer address.
+   * @param user_data Value reported with the completion.
+   */
+  void prepare_accept(int fd, sockaddr *address, socklen_t *length,
+                      uint64_t user_data);
+
+  /**
+   * @brief Prepares a read into a registered buffer.
+   * @param fd Descriptor to read from.
+   * @param buffer Destination inside registered buffer `index`.
+   * @param length Maximum number of bytes to read.
+   * @param index Index of the registered buffer.
+   * @param user_data Value reported with the completion.
+   */
+  void prepare_read_fixed(int fd, char *buffer, size_t length, unsigned index,
+                          uint64_t user_data);
+
+  /**
+   * @brief Prepares a read into a plain buffer.
+   * @param fd Descriptor to read from.
+   * @param buffer Destination buffer.
+   * @param length Maximum number of bytes to read.
+   * @param user_data Value reported with the completion.
+   */
+  void prepare_read(int fd, void *buffer, size_t length, uint64_t user_data);
+
+  /**
+   * @brief Prepares a `sendmsg()` with `MSG_NOSIGNAL`.
+   * @param fd Socket descriptor.
+   * @param message Message to send; must stay valid until completion.
+   * @param user_data Value reported with the completion.
+   */
+  void prepare_sendmsg(int fd, const struct msghdr *message,
+                       uint64_t user_data);
+
+  /**
+   * @brief Prepares a one-shot poll for the given events.
+   * @param fd Descriptor to poll.
+   * @param events Poll events (e.g. `POLLIN`).
+   * @param user_data Value reported with the completion.
+   */
+  void prepare_poll(int fd, uint32_t events, uint64_t user_data);
+
+  /**
+   * @brief Prepares a timeout completing after the given delay.
+   * @param milliseconds Delay in milliseconds.
+   * @param user_data Value reported with the completion.
+   */
+  void prepare_timeout(long long milliseconds, uint64_t user_data);
+
+  /**
+   * @brief Submits the prepared requests and waits for completions.
+   * @param wait_count Minimum number of completions to wait for.
+   * @return false on an unexpected `io_uring_enter()` failure.
+   */
+  bool submit_and_wait(unsigned wait_count);
+
+  /**
+   * @brief Moves every available completion into `completions`.
+   * @param completions Receives the completions, in order.
+   */
+  void reap(std::vector<IoUringCompletion> &completions);
+};
+
+} // namespace Purple::Net
+
+#endif
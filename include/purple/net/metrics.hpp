@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file metrics.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the latency histograms of the phases of Weblet requests.
+ *
+ * Every thread records into histograms of its own, so recording a sample
+ * takes no lock and no read-modify-write instruction; a scrape merges the
+ * histograms of all threads.
+ */
+#ifndef PURPLE_NET_METRICS_HPP
+#define PURPLE_NET_METRICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_METRICS_PATH
+ * @brief Default path of the metrics endpoint.
+ */
+#define WEBLET_METRICS_PATH "/metrics"
+
+/**
+ * @enum RequestPhase
+ * @brief Phases of the handling of a request timed by Weblet.
+ */
+enum class RequestPhase {
+  Accept,     ///< Accepting and registering a connection.
+  HeaderRead, ///< From the first bytes of a head until it is complete.
+  BodyRead,   ///< From the end of the head until the body is received.
+  Parse,      ///< Parsing the head and building the Request.
+  RouteMatch, ///< Looking the path up in the router.
+  Handler,    ///< Running middleware and handler, until the response.
+  Send        ///< From queuing responses until they are fully written.
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear histogram of durations in nanoseconds.
+ *
+ * Like an HDR histogram, each power of two is split into 16 linear
+ * sub-buckets, so a recorded value is known within 6.25%, from 1 ns up to
+ * about 137 s (longer durations fall in the last bucket). Only one thread
+ * may record into a histogram; any thread may read it.
+ */
+class LatencyHistogram {
+public:
+  static constexpr unsigned sub_bucket_bits = 4; ///< log2 of sub-buckets.
+  static constexpr unsigned max_exponent = 36;   ///< Last power of two.
+  static constexpr size_t bucket_count =
+      (max_exponent - sub_bucket_bits + 2) << sub_bucket_bits; ///< Buckets.
+
+  /**
+   * @brief Constructs an empty histogram.
+   */
+  LatencyHistogram() : counts(), sum(0) {}
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+  /**
+   * @brief Records a duration (owning thread only).
+   * @param nanos Duration in nanoseconds.
+   */
+  void record(uint64_t nanos);
+
+  /**
+   * @brief Adds the counts of the histogram to a merged histogram.
+   * @param merged Counts of each bucket, of size `bucket_count`.
+   * @param total Sum of the recorded durations (ns).
+   */
+  void merge_into(std::vector<uint64_t> &merged, uint64_t &total) const;
+
+  /**
+   * @brief Returns the bucket of a duration.
+   */
+  static size_t bucket_of(uint64_t nanos);
+
+  /**
+   * @brief Returns the largest duration (ns) falling in a bucket.
+   */
+  static uint64_t bucket_limit(size_t bucket);
+
+private:
+  std::atomic<uint64_t> counts[bucket_count]; ///< Samples of each bucket.
+  std::atomic<uint64_t> sum;                  ///< Sum of the samples (ns).
+};
+
+/**
+ * @class WebletMetrics
+ * @brief Latency histograms of each phase of each route of a Weblet.
+ *
+ * Histograms are allocated on the first sample a thread records for a
+ * route and phase, and are kept until the metrics are destroyed.
+ */
+class WebletMetrics {
+private:
+  /**
+   * @struct ThreadHistograms
+   * @brief Histograms a single thread records into.
+   */
+  struct ThreadHistograms {
+    std::thread::id owner; ///< Thread recording into the histograms.
+    std::unique_ptr<std::atomic<LatencyHistogram *>[]>
+        slots;    ///< Histogram of each route and phase, or null.
+    size_t count; ///< Number of slots.
+
+    ThreadHistograms(std::thread::id thread, size_t slot_count);
+    ThreadHistograms(const ThreadHistograms &) = delete;
+    ThreadHistograms &operator=(const ThreadHistograms &) = delete;
+    ~ThreadHistograms();
+  };
+
+  std::vector<std::string> routes; ///< Label of each route slot.
+  uint64_t generation;             ///< Identifies the instance to threads.
+  mutable std::mutex mutex;        ///< Guards `threads`.
+  std::vector<std::unique_ptr<ThreadHistograms>>
+      threads; ///< Histograms of every recording thread.
+
+  ThreadHistograms &local();
+
+public:
+  static constexpr size_t phase_count = 7; ///< Number of RequestPhases.
+
+  /**
+   * @brief Constructs metrics without samples.
+   * @param route_labels Label of each route slot; requests are recorded by
+   * slot index.
+   */
+  explicit WebletMetrics(std::vector<std::string> route_labels);
+
+  WebletMetrics(const WebletMetrics &) = delete;
+  WebletMetrics &operator=(const WebletMetrics &) = delete;
+
+  /**
+   * @brief Records the duration of a phase of a request.
+   * @param route Route slot of the request.
+   * @param phase Phase timed.
+   * @param nanos Duration in nanoseconds.
+   */
+  void record(size_t route, RequestPhase phase, uint64_t nanos);
+
+  /**
+   * @brief Renders the histograms in the Prometheus text format.
+   *
+   * Each route and phase with samples becomes a `weblet_phase_seconds`
+   * summary with its 0.5, 0.99 and 0.999 quantiles, sum and count.
+   */
+  std::string render() const;
+};
+
+/**
+ * @brief Returns the name of a phase, as used in metric labels.
+ */
+const char *phase_name(RequestPhase phase);
+
+} // namespace Purple::Net
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file rate_limiter.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the per-client rate limiter Weblet applies before routing.
+ *
+ * Limits follow the generic cell rate algorithm (GCRA), the token bucket
+ * expressed as a single "theoretical arrival time" per client. That time is
+ * an atomic integer updated with compare-and-swap, so checking a known
+ * client only takes a shared lock on one of many shards.
+ */
+#ifndef PURPLE_NET_RATE_LIMITER_HPP
+#define PURPLE_NET_RATE_LIMITER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_RATE_LIMIT_SHARDS
+ * @brief Number of independently locked shards of a rate limiter (64).
+ */
+#define WEBLET_RATE_LIMIT_SHARDS 64
+
+/**
+ * @def WEBLET_RATE_LIMIT_SWEEP_MS
+ * @brief Interval in milliseconds between two sweeps of the idle clients of
+ * a shard (10 s).
+ */
+#define WEBLET_RATE_LIMIT_SWEEP_MS 10000
+
+/**
+ * @class RateLimiter
+ * @brief Thread-safe GCRA limiter of requests per client key.
+ *
+ * Each key may send `burst` requests at once, then one request every
+ * `1 / rate` seconds. A key whose bucket has fully refilled is
+ * indistinguishable from an unknown key, so idle keys are dropped by
+ * periodic sweeps without losing any state.
+ */
+class RateLimiter {
+private:
+  /**
+   * @struct KeyHash
+   * @brief Transparent hash allowing lookups by `std::string_view`.
+   */
+  struct KeyHash {
+    using is_transparent = void; ///< Enables heterogeneous lookup.
+
+    size_t operator()(std::string_view key) const {
+      return std::hash<std::string_view>()(key);
+    }
+  };
+
+  /**
+   * @struct Shard
+   * @brief Keys hashing to the same shard and the lock guarding them.
+   */
+  struct Shard {
+    std::shared_mutex mutex; ///< Shared to update, exclusive to insert.
+    std::unordered_map<std::string, std::atomic<long long>, KeyHash,
+                       std::equal_to<>>
+        buckets;                       ///< Arrival time (ns) of each key.
+    std::atomic<long long> next_sweep; ///< Time (ns) of the next sweep.
+
+    Shard() : mutex(), buckets(), next_sweep(0) {}
+  };
+
+  long long interval;              ///< Nanoseconds between two requests.
+  long long tolerance;             ///< Nanoseconds of burst allowance.
+  std::unique_ptr<Shard[]> shards; ///< WEBLET_RATE_LIMIT_SHARDS shards.
+
+  bool update(std::atomic<long long> &bucket, long long now,
+              long long &retry_after);
+  void sweep(Shard &shard, long long now);
+
+public:
+  /**
+   * @brief Constructs a limiter.
+   * @param rate Sustained number of requests per second of a key.
+   * @param burst Number of requests a key may send at once.
+   */
+  RateLimiter(double rate, size_t burst);
+
+  RateLimiter(const RateLimiter &) = delete;
+  RateLimiter &operator=(const RateLimiter &) = delete;
+
+  /**
+   * @brief Counts a request of a key against its limit.
+   * @param key Client key (address, API key, ...).
+   * @param retry_after Receives, when the request is refused, the number of
+   * milliseconds until the key may send again.
+   * @return true if the request is allowed, false if it exceeds the limit.
+   */
+  bool allow(std::string_view key, long long &retry_after);
+
+  /**
+   * @brief Returns the number of keys currently tracked.
+   */
+  size_t size();
+};
+
+} // namespace Purple::Net
+
+#endif
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file request_body.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the building blocks Weblet uses to receive request bodies
+ * incrementally.
+ *
+ * Bodies are decoded (`Transfer-Encoding: chunked`), split into multipart
+ * parts and spooled to temporary files while they arrive, so the memory
+ * needed for a request does not grow with the size of its body.
+ */
+#ifndef PURPLE_NET_REQUEST_BODY_HPP
+#define PURPLE_NET_REQUEST_BODY_HPP
+
+#include <purple/net/http_parser.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Purple::Net {
+
+/**
+ * @class TempFile
+ * @brief A temporary file holding spooled request data.
+ *
+ * The file is removed when the object is destroyed. Handlers that want to
+ * keep it can rename() it elsewhere first.
+ */
+class TempFile {
+private:
+  int fd;           ///< Read/write descriptor of the file.
+  std::string path; ///< Filesystem path of the file.
+  size_t length;    ///< Number of bytes written so far.
+
+public:
+  /**
+   * @brief Takes ownership of an open temporary file.
+   * @param descriptor Open read/write descriptor.
+   * @param file_path Filesystem path of the file.
+   */
+  TempFile(int descriptor, const std::string &file_path)
+      : fd(descriptor), path(file_path), length(0) {}
+
+  TempFile(const TempFile &) = delete;
+  TempFile &operator=(const TempFile &) = delete;
+
+  /**
+   * @brief Destructor closes and removes the file.
+   */
+  ~TempFile();
+
+  /**
+   * @brief Creates a new, empty temporary file.
+   * @param directory Directory to create the file in.
+   * @return The file, or null if it could not be created.
+   */
+  static std::shared_ptr<TempFile> create(const std::string &directory);
+
+  /**
+   * @brief Appends data to the file.
+   * @param data Bytes to append.
+   * @return false if the data could not be written.
+   */
+  bool write(std::string_view data);
+
+  /**
+   * @brief Reads bytes from the file without moving any shared offset.
+   * @param buffer Destination buffer.
+   * @param size Maximum number of bytes to read.
+   * @param offset Offset of the first byte to read.
+   * @return Number of bytes read; 0 at the end of the file or on error.
+   */
+  size_t read(char *buffer, size_t size, size_t offset) const;
+
+  /**
+   * @brief Returns the filesystem path of the file.
+   */
+  const std::string &file_path() const;
+
+  /**
+   * @brief Returns the number of bytes written to the file.
+   */
+  size_t size() const;
+};
+
+/**
+ * @class BodyReader
+ * @brief Sequential reader over a request body, wherever it is stored.
+ *
+ * Reads from the in-memory body or from the temporary file it was spooled
+ * to. The reader refers to the request it was obtained from and must not
+ * outlive it.
+ */
+class BodyReader {
+private:
+  std::string_view memory;        ///< In-memory body (if not spooled).
+  std::shared_ptr<TempFile> file; ///< Spooled body (if any).
+  size_t position;                ///< Offset of the next byte to read.
+
+public:
+  /**
+   * @brief Constructs a reader over a body.
+   * @param contents In-memory body, used when `spooled` is null.
+   * @param spooled Temporary file holding the body, or null.
+   */
+  BodyReader(const std::string &contents, std::shared_ptr<TempFile> spooled)
+      : memory(contents), file(std::move(spooled)), position(0) {}
+
+  /**
+   * @brief Returns the total size of the body in bytes.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Reads the next bytes of the body.
+   * @param buffer Destination buffer.
+   * @param length Maximum number of bytes to read.
+   * @return Number of bytes read; 0 once the whole body has been read.
+   */
+  size_t read(char *buffer, size_t length);
+
+  /**
+   * @brief Reads the next chunk of the body.
+   * @param chunk Receives up to `max_length` bytes.
+   * @param max_length Maximum chunk size.
+   * @return false once the whole body has been read.
+   */
+  bool read_chunk(std::string &chunk, size_t max_length = 65536);
+};
+
+/**
+ * @class ChunkedDecoder
+ * @brief Incremental decoder of `Transfer-Encoding: chunked` bodies.
+ *
+ * Chunk extensions and trailer fields are accepted and ignored.
+ */
+class ChunkedDecoder {
+private:
+  /**
+   * @enum State
+   * @brief Position of the decoder within the chunked body.
+   */
+  enum class State { Size, Data, DataEnd, Trailer, Complete, Error };
+
+  State state;      ///< Current decoder state.
+  size_t remaining; ///< Bytes left in the current chunk.
+
+public:
+  /**
+   * @brief Constructs a decoder expecting the first chunk size line.
+   */
+  ChunkedDecoder() : state(State::Size), remaining(0) {}
+
+  /**
+   * @brief Decodes the next piece of a chunked body.
+   *
+   * Has to be called repeatedly, dropping `consumed` bytes from the input
+   * every time, for as long as it consumes input and returns
+   * HttpParseStatus::Incomplete.
+   *
+   * @param input Received bytes not yet consumed.
+   * @param consumed Receives the number of input bytes used.
+   * @param data Receives decoded body bytes (a view into `input`).
+   * @return Complete after the last chunk, Error if the body is malformed.
+   */
+  HttpParseStatus next(std::string_view input, size_t &consumed,
+                       std::string_view &data);
+};
+
+/**
+ * @class MultipartParser
+ * @brief Incremental parser of `multipart/form-data` bodies.
+ *
+ * Parts are reported through callbacks as soon as their bytes arrive; only
+ * a delimiter's worth of data is held back between calls. A callback may
+ * return false to abort parsing.
+ */
+class MultipartParser {
+public:
+  using PartBegin = std::function<bool(const HeaderMap &headers)>;
+  using PartData = std::function<bool(std::string_view data)>;
+  using PartEnd = std::function<bool()>;
+
+private:
+  /**
+   * @enum State
+   * @brief Position of the parser within the multipart body.
+   */
+  enum class State { Preamble, Boundary, Headers, Data, Complete, Error };
+
+  State state;           ///< Current parser state.
+  std::string delimiter; ///< `CRLF--boundary`.
+  std::string pending;   ///< Received bytes not yet reported.
+
+  PartBegin part_begin; ///< Called with the headers of each part.
+  PartData part_data;   ///< Called with the contents of the current part.
+  PartEnd part_end;     ///< Called at the end of each part.
+
+public:
+  /**
+   * @brief Constructs a parser for the given boundary.
+   * @param boundary Boundary from the `Content-Type` header.
+   * @param begin Called with the headers of each part.
+   * @param data Called with the contents of the current part.
+   * @param end Called at the end of each part.
+   */
+  MultipartParser(const std::string &boundary, PartBegin begin, PartData data,
+                  PartEnd end)
+      : state(State::Preamble), delimiter("\r\n--" + boundary), pending(),
+        part_begin(std::move(begin)), part_data(std::move(data)),
+        part_end(std::move(end)) {}
+
+  /**
+   * @brief Parses the next bytes of the body.
+   * @param data Received body bytes.
+   * @return false if the body is malformed or a callback failed.
+   */
+  bool feed(std::string_view data);
+
+  /**
+   * @brief Returns whether the closing delimiter has been parsed.
+   */
+  bool complete() const;
+};
+
+/**
+ * @brief Extracts a parameter from a header value such as
+ * `form-data; name="file"; filename="a.txt"`.
+ * @param header Header value.
+ * @param name Parameter name, matched case-insensitively.
+ * @param value Receives the (unquoted) parameter value.
+ * @return true if the parameter is present.
+ */
+bool header_parameter(std::string_view header, std::string_view name,
+                      std::string &value);
+
+} // namespace Purple::Net
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file response_cache.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the cache of serialized responses of cached Weblet routes.
+ *
+ * Entries live in a MemoryCache::LruCache. Concurrent misses of a key are
+ * coalesced: the first one fills the entry while the others wait for it,
+ * and stale entries are refreshed by a single request while the others keep
+ * being served the stale copy.
+ */
+#ifndef PURPLE_NET_RESPONSE_CACHE_HPP
+#define PURPLE_NET_RESPONSE_CACHE_HPP
+
+#include <purple/memcache/cache.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_RESPONSE_CACHE_SIZE
+ * @brief Default maximum size of the response cache in bytes (64 MB).
+ */
+#define WEBLET_RESPONSE_CACHE_SIZE 67108864
+
+/**
+ * @def WEBLET_RESPONSE_CACHE_ITEMS
+ * @brief Default maximum number of responses in the response cache (10000).
+ */
+#define WEBLET_RESPONSE_CACHE_ITEMS 10000
+
+/**
+ * @struct CachePolicy
+ * @brief Describes how the responses of a route are cached.
+ *
+ * Only `GET` requests are cached, and only `200 OK` responses without
+ * cookies, files or streamed bodies whose `Cache-Control` allows it
+ * (`no-store`, `no-cache` and `private` do not).
+ */
+struct CachePolicy {
+  std::vector<std::string>
+      query_params; ///< Query parameters part of the key, others ignored.
+  std::vector<std::string> vary;    ///< Request headers part of the key.
+  long long max_age;                ///< Freshness (s) without `max-age`.
+  long long stale_while_revalidate; ///< Default stale serving window (s).
+
+  /**
+   * @brief Constructs a policy caching only responses carrying
+   * `Cache-Control: max-age`.
+   */
+  CachePolicy()
+      : query_params(), vary(), max_age(0), stale_while_revalidate(0) {}
+};
+
+/**
+ * @struct CachedResponse
+ * @brief A serialized response stored in the response cache.
+ */
+struct CachedResponse {
+  std::string head;      ///< Status line and headers, without `Connection`.
+  std::string body;      ///< Response body.
+  long long stored_at;   ///< Monotonic time (ms) the response was produced.
+  long long fresh_until; ///< Time (ms) until which it is served as is.
+  long long stale_until; ///< Time (ms) until which it is served stale.
+};
+
+/**
+ * @enum CacheLookup
+ * @brief Outcome of a response cache lookup.
+ */
+enum class CacheLookup {
+  Hit,     ///< A usable entry was found.
+  Refresh, ///< A stale entry was found; the caller must refresh it.
+  Miss,    ///< No entry; the caller must produce and complete it.
+  Pending  ///< No entry; the waiter is called once it is produced.
+};
+
+/**
+ * @typedef CacheWaiter
+ * @brief Called with the entry a coalesced request waited for, or with null
+ * when the response turned out not to be cacheable.
+ */
+using CacheWaiter =
+    std::function<void(std::shared_ptr<const CachedResponse> entry)>;
+
+/**
+ * @class ResponseCache
+ * @brief Thread-safe cache of serialized responses with miss coalescing.
+ *
+ * Every Miss or Refresh returned by lookup() must be followed by exactly one
+ * complete() of the same key.
+ */
+class ResponseCache {
+private:
+  Purple::MemoryCache::LruCache<std::string,
+                                std::shared_ptr<const CachedResponse>>
+      entries;              ///< Cached responses by key.
+  std::mutex filling_mutex; ///< Guards `filling`.
+  std::unordered_map<std::string, std::vector<CacheWaiter>>
+      filling; ///< Requests waiting for each key being produced.
+
+public:
+  /**
+   * @brief Constructs an empty cache.
+   * @param max_bytes Maximum total size of the cached responses.
+   * @param max_items Maximum number of cached responses.
+   */
+  ResponseCache(size_t max_bytes, size_t max_items);
+
+  /**
+   * @brief Looks up the response of a key.
+   *
+   * @param key Cache key of the request.
+   * @param now Current monotonic time in milliseconds.
+   * @param entry Receives the entry on Hit and Refresh.
+   * @param make_waiter Returns the waiter to queue on Pending; not called
+   * otherwise.
+   * @return The outcome of the lookup.
+   */
+  template <typename MakeWaiter>
+  CacheLookup lookup(const std::string &key, long long now,
+                     std::shared_ptr<const CachedResponse> &entry,
+                     MakeWaiter make_waiter) {
+    std::lock_guard<std::mutex> lock(this->filling_mutex);
+    auto pending = this->filling.find(key);
+
+    if (!this->entries.get(key, entry) || now >= entry->stale_until) {
+      entry.reset();
+
+      if (pending == this->filling.end()) {
+        this->filling.emplace(key, std::vector<CacheWaiter>());
+        return CacheLookup::Miss;
+      }
+
+      pending->second.push_back(make_waiter());
+      return CacheLookup::Pending;
+    } else if (now < entry->fresh_until || pending != this->filling.end())
+      return CacheLookup::Hit;
+
+    this->filling.emplace(key, std::vector<CacheWaiter>());
+    return CacheLookup::Refresh;
+  }
+
+  /**
+   * @brief Completes a Miss or Refresh, storing the produced entry.
+   * @param key Cache key.
+   * @param entry The produced entry, or null if it is not cacheable.
+   * @return The waiters queued for the key, to be called with `entry`.
+   */
+  std::vector<CacheWaiter>
+  complete(const std::string &key,
+           std::shared_ptr<const CachedResponse> entry);
+};
+
+} // namespace Purple::Net
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file router.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the radix tree router used by Weblet to match request
+ * paths against registered route patterns.
+ *
+ * Patterns are made of static text, `{name}` parameters capturing text up to
+ * the next `/` (or up to the first occurrence of the character starting the
+ * static text that follows them in the same segment, e.g. `.` in
+ * `{name}.json`), and a trailing `{name*}` or `*` wildcard capturing the
+ * rest of the path. Matching walks the tree once per path character, never
+ * allocates, and captures parameter values as views into the request path.
+ */
+#ifndef PURPLE_NET_ROUTER_HPP
+#define PURPLE_NET_ROUTER_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_MAX_ROUTE_PARAMS
+ * @brief Maximum number of parameters captured by a single route (16).
+ */
+#define WEBLET_MAX_ROUTE_PARAMS 16
+
+/**
+ * @struct RouteMatch
+ * @brief Result of a successful route lookup.
+ *
+ * Parameter values are views into the matched path, in the order their
+ * placeholders appear in the route pattern.
+ */
+struct RouteMatch {
+  size_t route;       ///< Identifier the matched pattern was inserted with.
+  size_t param_count; ///< Number of captured parameters.
+  std::array<std::string_view, WEBLET_MAX_ROUTE_PARAMS>
+      params; ///< Captured parameter values.
+
+  /**
+   * @brief Constructs an empty match.
+   */
+  RouteMatch() : route(0), param_count(0), params() {}
+};
+
+/**
+ * @class Router
+ * @brief Radix (compressed prefix) tree of route patterns.
+ *
+ * When several patterns match a path, static text is preferred over a
+ * parameter and a parameter over a wildcard, independently of the order in
+ * which the patterns were inserted. The tree must not be modified while it
+ * is being matched against.
+ */
+class Router {
+private:
+  /**
+   * @struct Node
+   * @brief A radix tree node.
+   */
+  struct Node {
+    std::string prefix;  ///< Static text consumed by this node.
+    std::string indices; ///< First character of each static child.
+    std::vector<std::unique_ptr<Node>> children; ///< Static children.
+    std::unique_ptr<Node> param;    ///< Child consuming a `{name}` value.
+    std::unique_ptr<Node> wildcard; ///< Child consuming the rest.
+    size_t route;   ///< Route identifier if a pattern ends here, else npos.
+    char delimiter; ///< Besides `/`, ends the value of a parameter node.
+
+    Node()
+        : prefix(), indices(), children(), param(), wildcard(),
+          route(std::string::npos), delimiter('/') {}
+  };
+
+  Node root; ///< Root node (empty prefix).
+
+  Node *insert_static(Node *node, std::string_view text);
+  bool match_node(const Node &node, std::string_view path,
+                  RouteMatch &match) const;
+
+public:
+  /**
+   * @brief Constructs an empty router.
+   */
+  Router() : root() {}
+
+  /**
+   * @brief Inserts a route pattern.
+   * @param pattern Route pattern (e.g. `/users/{id}/files/{path*}`).
+   * @param route Identifier returned in matches of this pattern.
+   * @param param_names Receives the parameter names in pattern order.
+   * @return false if the pattern is malformed, has too many parameters,
+   * follows a parameter with a different character within its segment than
+   * an earlier pattern did, or was already inserted (the first insertion is
+   * kept).
+   */
+  bool insert(std::string_view pattern, size_t route,
+              std::vector<std::string> &param_names);
+
+  /**
+   * @brief Matches a request path against the inserted patterns.
+   * @param path Request path, without query string.
+   * @param match Receives the route identifier and parameter values.
+   * @return true if a pattern matched.
+   */
+  bool match(std::string_view path, RouteMatch &match) const;
+};
+
+} // namespace Purple::Net
+
+#endif
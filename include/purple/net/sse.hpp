@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file sse.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the publisher of Server-Sent Events streams.
+ *
+ * Subscribers are connections parked on their event loop; no worker thread
+ * is held while they wait. A published event is encoded once and the same
+ * buffer is queued to every subscriber, in a single wake-up per event loop.
+ */
+#ifndef PURPLE_NET_SSE_HPP
+#define PURPLE_NET_SSE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Purple::Net {
+
+struct EventLoop;
+
+/**
+ * @def WEBLET_SSE_HISTORY
+ * @brief Default number of past events kept for `Last-Event-ID` replay
+ * (1024).
+ */
+#define WEBLET_SSE_HISTORY 1024
+
+/**
+ * @def WEBLET_SSE_MAX_BACKLOG
+ * @brief Default number of unwritten buffers a subscriber may have queued
+ * before its overflow policy applies (256).
+ */
+#define WEBLET_SSE_MAX_BACKLOG 256
+
+/**
+ * @enum SseOverflow
+ * @brief What happens to a subscriber too slow to keep up with the events.
+ */
+enum class SseOverflow {
+  Disconnect, ///< Close the stream; the client resumes with `Last-Event-ID`.
+  DropNewest  ///< Skip events until the backlog drains.
+};
+
+/**
+ * @class SsePublisher
+ * @brief Thread-safe source of the events of one or more SSE routes.
+ *
+ * Events get increasing identifiers starting at 1. The last events are kept
+ * in a ring buffer, so that a client reconnecting with `Last-Event-ID`
+ * receives those it missed (as long as they are still in the ring).
+ */
+class SsePublisher {
+private:
+  mutable std::mutex mutex; ///< Guards the fields below.
+  uint64_t last_id;         ///< Identifier of the last published event.
+  std::deque<std::pair<uint64_t, std::shared_ptr<const std::string>>>
+      history; ///< Last encoded events, oldest first.
+  std::map<std::pair<EventLoop *, uint64_t>, int>
+      subscribers; ///< Descriptor of each subscribed connection.
+
+  const size_t history_size;  ///< Capacity of `history`.
+  const size_t backlog_limit; ///< Unwritten buffers allowed per subscriber.
+  const SseOverflow overflow; ///< Policy applied beyond `backlog_limit`.
+
+  void deliver(std::shared_ptr<const std::string> event);
+
+public:
+  /**
+   * @brief Constructs a publisher without subscribers.
+   * @param history Number of past events kept for replay.
+   * @param max_backlog Unwritten buffers allowed per subscriber.
+   * @param policy What to do with subscribers beyond `max_backlog`.
+   */
+  explicit SsePublisher(size_t history = WEBLET_SSE_HISTORY,
+                        size_t max_backlog = WEBLET_SSE_MAX_BACKLOG,
+                        SseOverflow policy = SseOverflow::Disconnect);
+
+  SsePublisher(const SsePublisher &) = delete;
+  SsePublisher &operator=(const SsePublisher &) = delete;
+
+  /**
+   * @brief Publishes an event to every subscriber.
+   * @param data Event data; each line becomes a `data:` field.
+   * @param event Event type, or empty for the default `message`.
+   * @return Identifier of the event.
+   */
+  uint64_t publish(std::string_view data, std::string_view event = "");
+
+  /**
+   * @brief Sends a comment line to every subscriber, keeping idle streams
+   * (and the proxies in front of them) alive. Not kept for replay.
+   */
+  void heartbeat();
+
+  /**
+   * @brief Returns the number of subscribed connections.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Returns the number of unwritten buffers allowed per subscriber.
+   */
+  size_t max_backlog() const;
+
+  /**
+   * @brief Returns the policy applied to subscribers beyond max_backlog().
+   */
+  SseOverflow overflow_policy() const;
+
+  /**
+   * @brief Subscribes a connection (called by its event loop).
+   * @param loop Loop owning the connection.
+   * @param identifier Identifier of the connection.
+   * @param descriptor Descriptor of the connection.
+   * @param last_event_id Last event the client received, or 0.
+   * @return The kept events published after `last_event_id`, to be queued
+   * before any event delivered from now on.
+   */
+  std::vector<std::shared_ptr<const std::string>>
+  subscribe(EventLoop *loop, uint64_t identifier, int descriptor,
+            uint64_t last_event_id);
+
+  /**
+   * @brief Unsubscribes a connection (called by its event loop).
+   * @param loop Loop owning the connection.
+   * @param identifier Identifier of the connection.
+   */
+  void unsubscribe(EventLoop *loop, uint64_t identifier);
+};
+
+/**
+ * @brief Encodes an event in the `text/event-stream` format.
+ * @param id Event identifier.
+ * @param event Event type, or empty.
+ * @param data Event data, split into one `data:` field per line.
+ * @return The serialized event.
+ */
+std::string encode_sse_event(uint64_t id, std::string_view event,
+                             std::string_view data);
+
+} // namespace Purple::Net
+
+#endif
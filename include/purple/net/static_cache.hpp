@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file static_cache.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the in-memory cache of static assets served by Weblet.
+ *
+ * Assets are opened once, small ones read into memory, and kept together
+ * with their precomputed `Content-Type`, a strong `ETag` and their
+ * `Last-Modified` date, so that repeated hits (and conditional requests
+ * answered with 304) never touch the filesystem. Entries are invalidated
+ * through inotify watches on the directories they live in.
+ *
+ * With compression enabled, each asset also carries a gzip variant: its
+ * precompressed `.gz` sibling when there is an up-to-date one, or else the
+ * asset compressed once when it is loaded.
+ */
+#ifndef PURPLE_NET_STATIC_CACHE_HPP
+#define PURPLE_NET_STATIC_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Purple::Net {
+
+struct ResponseFile;
+
+/**
+ * @def WEBLET_STATIC_CACHE_MAX_ENTRIES
+ * @brief Maximum number of assets kept in a static cache (1024).
+ */
+#define WEBLET_STATIC_CACHE_MAX_ENTRIES 1024
+
+/**
+ * @struct StaticAsset
+ * @brief A cached static file with its precomputed response metadata.
+ *
+ * Small files are read into `encoded` when loaded; larger ones have no
+ * contents and are sent from the descriptor, which is kept open for
+ * zero-copy `sendfile()` transfers. Variants compressed in memory have no
+ * file; their contents also point into `encoded`.
+ */
+struct StaticAsset {
+  std::string content_type;  ///< MIME type derived from the file name.
+  std::string etag;          ///< Strong entity tag (quoted).
+  std::string last_modified; ///< Modification date as an HTTP date.
+  std::time_t modified_time; ///< Modification time in seconds.
+
+  size_t size;                        ///< File size in bytes.
+  const char *contents;               ///< In-memory contents, if any.
+  std::shared_ptr<ResponseFile> file; ///< Open descriptor of the file.
+  std::string encoded;                ///< Bytes behind `contents`.
+  std::shared_ptr<const StaticAsset>
+      gzip; ///< Gzip encoded variant, if any.
+
+  /**
+   * @brief Constructs an empty asset with no contents.
+   */
+  StaticAsset()
+      : content_type(), etag(), last_modified(), modified_time(0), size(0),
+        contents(nullptr), file(), encoded(), gzip() {}
+
+  StaticAsset(const StaticAsset &) = delete;
+  StaticAsset &operator=(const StaticAsset &) = delete;
+};
+
+/**
+ * @class StaticCache
+ * @brief Thread-safe cache of the static assets below a public directory.
+ *
+ * Lookups are served under a shared lock. Misses load the file, read it if
+ * small and add an inotify watch on its directory; the owner polls
+ * watch_desc() and calls process_events() to drop entries whose files
+ * changed. When inotify
+ * is unavailable nothing is cached and every lookup reads the filesystem.
+ *
+ * Assets should be updated by writing a new file and renaming it into place;
+ * a response sent from a file truncated in place ends early and its
+ * connection is closed.
+ */
+class StaticCache {
+private:
+  std::string root;       ///< Public directory the assets are served from.
+  int inotify_desc;       ///< Non-blocking inotify descriptor (-1 if off).
+  size_t memory_max_size; ///< Largest asset read into memory.
+
+  size_t compression_min_size; ///< Smallest asset given a gzip variant.
+  bool compression_enabled;    ///< Assets get gzip variants.
+
+  std::shared_mutex mutex; ///< Protects the members below.
+  std::unordered_map<std::string, std::shared_ptr<const StaticAsset>>
+      entries; ///< Cached assets keyed by request path.
+  std::unordered_map<int, std::string>
+      watches; ///< Watched directories (request path prefix) by descriptor.
+  uint64_t generation; ///< Bumped on every batch of inotify events.
+
+  std::shared_ptr<const StaticAsset> load(const std::string &path);
+  std::shared_ptr<const StaticAsset> load_gzip(const std::string &path,
+                                               const StaticAsset &asset);
+  void watch_directory(const std::string &directory);
+  void invalidate_prefix(const std::string &prefix);
+
+public:
+  /**
+   * @brief Constructs a cache for the given public directory.
+   * @param root_dir Filesystem path of the public directory.
+   */
+  explicit StaticCache(const std::string &root_dir);
+
+  StaticCache(const StaticCache &) = delete;
+  StaticCache &operator=(const StaticCache &) = delete;
+
+  /**
+   * @brief Destructor closes the inotify descriptor.
+   */
+  ~StaticCache();
+
+  /**
+   * @brief Looks an asset up, loading it on a miss.
+   * @param path Request path of the asset (e.g. `/css/app.css`).
+   * @return The asset, or null if the path is not a regular file.
+   */
+  std::shared_ptr<const StaticAsset> find(const std::string &path);
+
+  /**
+   * @brief Sets the largest asset read into memory when loaded.
+   * @param max_size Size in bytes; larger assets are sent from their file.
+   */
+  void set_memory_limit(size_t max_size);
+
+  /**
+   * @brief Gives assets loaded from now on a gzip variant.
+   * @param min_size Smallest asset compressed in memory.
+   */
+  void enable_compression(size_t min_size);
+
+  /**
+   * @brief Returns the inotify descriptor to poll for invalidations.
+   * @return The descriptor, or -1 if caching is disabled.
+   */
+  int watch_desc() const;
+
+  /**
+   * @brief Drains pending inotify events and drops the affected entries.
+   */
+  void process_events();
+};
+
+/**
+ * @brief Formats a time point as an HTTP date (IMF-fixdate).
+ * @param time Seconds since the epoch.
+ * @return The date, e.g. `Sun, 06 Nov 1994 08:49:37 GMT`.
+ */
+std::string format_http_date(std::time_t time);
+
+/**
+ * @brief Parses an HTTP date (IMF-fixdate).
+ * @param date The date string.
+ * @param time Receives the seconds since the epoch.
+ * @return true if the date was well-formed.
+ */
+bool parse_http_date(std::string_view date, std::time_t &time);
+
+} // namespace Purple::Net
+
+#endif
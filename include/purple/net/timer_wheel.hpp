@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file timer_wheel.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the hierarchical timing wheel Weblet event loops use to
+ * expire connection timeouts.
+ *
+ * Scheduling a timer and expiring it are O(1) amortized, whatever the number
+ * of timers: a timer is appended to the slot of the wheel level covering its
+ * deadline and moves down one level each time the lower level wraps around.
+ * Timers cannot be cancelled; owners ignore stale expirations instead.
+ */
+#ifndef PURPLE_NET_TIMER_WHEEL_HPP
+#define PURPLE_NET_TIMER_WHEEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Purple::Net {
+
+/**
+ * @def WEBLET_TIMER_TICK_MS
+ * @brief Resolution of the timing wheel in milliseconds (100 ms).
+ */
+#define WEBLET_TIMER_TICK_MS 100
+
+/**
+ * @def WEBLET_TIMER_WHEEL_BITS
+ * @brief Log2 of the number of slots per wheel level (64 slots).
+ */
+#define WEBLET_TIMER_WHEEL_BITS 6
+
+/**
+ * @def WEBLET_TIMER_WHEEL_LEVELS
+ * @brief Number of wheel levels (4 levels of 64 slots span about 19 days at
+ * WEBLET_TIMER_TICK_MS).
+ */
+#define WEBLET_TIMER_WHEEL_LEVELS 4
+
+/**
+ * @struct TimerEntry
+ * @brief A scheduled connection timeout.
+ */
+struct TimerEntry {
+  int fd;             ///< Descriptor of the connection.
+  uint64_t id;        ///< Identifier of the connection.
+  long long deadline; ///< Monotonic time (ms) the timer expires at.
+};
+
+/**
+ * @class TimerWheel
+ * @brief Hierarchical timing wheel of connection timeouts.
+ *
+ * Level `n` has 64 slots of 64^n ticks each. Deadlines are rounded up to the
+ * next tick, so timers expire at most one tick late and never early. The
+ * wheel is not thread-safe; it belongs to a single event loop.
+ */
+class TimerWheel {
+private:
+  static constexpr size_t slot_count = 1u << WEBLET_TIMER_WHEEL_BITS;
+  static constexpr size_t slot_mask = slot_count - 1;
+
+  std::array<std::vector<TimerEntry>, slot_count * WEBLET_TIMER_WHEEL_LEVELS>
+      slots;             ///< Timers of every level, level by level.
+  long long tick_ms;     ///< Duration of a tick in milliseconds.
+  long long current;     ///< Last tick that has been expired.
+  size_t timer_count;    ///< Number of timers in the wheel.
+
+  void place(const TimerEntry &entry);
+  void cascade(size_t level);
+
+public:
+  /**
+   * @brief Constructs an empty wheel.
+   * @param now Current monotonic time in milliseconds.
+   * @param tick Duration of a tick in milliseconds.
+   */
+  TimerWheel(long long now = 0, long long tick = WEBLET_TIMER_TICK_MS)
+      : slots(), tick_ms(tick), current(now / tick), timer_count(0) {}
+
+  /**
+   * @brief Schedules a timer. Deadlines in the past expire on the next
+   * advance().
+   * @param entry The timer.
+   */
+  void schedule(const TimerEntry &entry);
+
+  /**
+   * @brief Expires every timer whose deadline has passed.
+   * @param now Current monotonic time in milliseconds.
+   * @param expired Receives the expired timers.
+   */
+  void advance(long long now, std::vector<TimerEntry> &expired);
+
+  /**
+   * @brief Returns the number of scheduled timers.
+   */
+  size_t size() const;
+};
+
+} // namespace Purple::Net
+
+#endif
@@ -32,36 +32,199 @@
 #define PURPLE_NET_WEBLET_HPP
 
 #include <purple/concurrent/channel.hpp>
+#include <purple/concurrent/task.hpp>
 #include <purple/concurrent/tasklet.hpp>
 #include <purple/format/dotenv.hpp>
+#include <purple/net/arena.hpp>
+#include <purple/net/compression.hpp>
+#include <purple/net/event_loop.hpp>
+#include <purple/net/metrics.hpp>
+#include <purple/net/rate_limiter.hpp>
+#include <purple/net/response_cache.hpp>
+#include <purple/net/request_body.hpp>
+#include <purple/net/router.hpp>
+#include <purple/net/sse.hpp>
+#include <purple/net/static_cache.hpp>
+#include <purple/net/websocket.hpp>
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Purple::Net {
 
 using namespace Purple::Concurrent;
 
+/**
+ * @def WEBLET_MAX_EVENTS
+ * @brief Maximum number of epoll events handled per loop iteration (256).
+ */
+#define WEBLET_MAX_EVENTS 256
+
+/**
+ * @def WEBLET_RECV_CHUNK_SIZE
+ * @brief Size in bytes of a single non-blocking `recv()` call (16 KB).
+ */
+#define WEBLET_RECV_CHUNK_SIZE 16384
+
+/**
+ * @def WEBLET_KEEP_ALIVE_TIMEOUT_SECONDS
+ * @brief Default idle timeout of persistent connections in seconds (5s).
+ */
+#define WEBLET_KEEP_ALIVE_TIMEOUT_SECONDS 5
+
+/**
+ * @def WEBLET_HEADER_TIMEOUT_SECONDS
+ * @brief Default time allowed to receive a complete request head (10s).
+ */
+#define WEBLET_HEADER_TIMEOUT_SECONDS 10
+
+/**
+ * @def WEBLET_BODY_TIMEOUT_SECONDS
+ * @brief Default time allowed between two reads of a request body (30s).
+ */
+#define WEBLET_BODY_TIMEOUT_SECONDS 30
+
+/**
+ * @def WEBLET_WRITE_TIMEOUT_SECONDS
+ * @brief Default time allowed between two writes of a response (30s).
+ */
+#define WEBLET_WRITE_TIMEOUT_SECONDS 30
+
+/**
+ * @def WEBLET_RETRY_AFTER_SECONDS
+ * @brief Default `Retry-After` delay of overload responses in seconds (1s).
+ */
+#define WEBLET_RETRY_AFTER_SECONDS 1
+
+/**
+ * @def WEBLET_MAX_PIPELINED_REQUESTS
+ * @brief Maximum number of in-flight requests per connection (16).
+ *
+ * Responses produced but not yet written count against the limit. Further
+ * pipelined requests stay buffered until earlier responses have been
+ * written; the connection is not read while more than
+ * WEBLET_MAX_HEADER_SIZE bytes are left unparsed.
+ */
+#define WEBLET_MAX_PIPELINED_REQUESTS 16
+
+/**
+ * @def WEBLET_SENDFILE_THRESHOLD
+ * @brief Size in bytes above which static files are sent with `sendfile()`
+ * instead of being read into the response body (16 KB).
+ */
+#define WEBLET_SENDFILE_THRESHOLD 16384
+
+/**
+ * @def WEBLET_MAX_IOVECS
+ * @brief Maximum number of response segments gathered into one `sendmsg()`
+ * call (64).
+ */
+#define WEBLET_MAX_IOVECS 64
+
+/**
+ * @def WEBLET_URING_ENTRIES
+ * @brief Submission queue size of the io_uring backend (1024 entries).
+ */
+#define WEBLET_URING_ENTRIES 1024
+
+/**
+ * @def WEBLET_URING_BUFFERS
+ * @brief Number of receive buffers registered with each io_uring event loop
+ * (256 buffers of WEBLET_RECV_CHUNK_SIZE bytes).
+ *
+ * Idle connections wait for readability without a buffer; a buffer is only
+ * taken once data has arrived and is released as soon as it is copied out.
+ * When every buffer is in use, readable connections wait for one.
+ */
+#define WEBLET_URING_BUFFERS 256
+
+/**
+ * @def WEBLET_BODY_SPOOL_THRESHOLD
+ * @brief Size in bytes above which request bodies and uploaded files are
+ * spooled to temporary files instead of being kept in memory (1 MB).
+ */
+#define WEBLET_BODY_SPOOL_THRESHOLD 1048576
+
+/**
+ * @def WEBLET_MAX_BODY_SIZE
+ * @brief Default maximum size in bytes of a request body (64 MB).
+ */
+#define WEBLET_MAX_BODY_SIZE 67108864
+
+/**
+ * @def WEBLET_STREAM_BUFFER_LIMIT
+ * @brief Number of unsent bytes of a streamed response above which its
+ * producer is paused until the client catches up (256 KB).
+ */
+#define WEBLET_STREAM_BUFFER_LIMIT 262144
+
+/**
+ * @def WEBLET_MAX_BYTE_RANGES
+ * @brief Number of ranges a `Range` header may ask for before it is ignored
+ * and the whole file is sent (16).
+ */
+#define WEBLET_MAX_BYTE_RANGES 16
+
 /**
  * @struct UploadedFile
  * @brief Represents a file uploaded through a multipart/form-data HTTP request.
  *
- * Uploaded files are stored in memory, including metadata such as filename,
- * MIME content type, and raw binary data.
+ * Small files are stored in memory, including metadata such as filename,
+ * MIME content type, and raw binary data. Files larger than the spool
+ * threshold are written to a temporary file while they are received and
+ * `data` stays empty; files passed to an upload sink are stored wherever the
+ * sink put them.
  */
 struct UploadedFile {
   std::string filename;      ///< Original name of the uploaded file.
   std::string content_type;  ///< MIME type of the file.
-  std::vector<uint8_t> data; ///< Raw binary file contents.
+  std::vector<uint8_t> data; ///< Raw binary file contents (if in memory).
+  size_t size;               ///< Size of the file in bytes.
+  std::shared_ptr<TempFile>
+      spooled; ///< Temporary file holding the contents (if spooled).
+  std::string location; ///< Where an upload sink stored the contents.
 
   /**
    * @brief Default constructor initializes empty file metadata.
    */
-  UploadedFile() : filename(""), content_type(""), data() {}
+  UploadedFile()
+      : filename(""), content_type(""), data(), size(0), spooled(),
+        location("") {}
+};
+
+/**
+ * @class UploadSink
+ * @brief Destination of a streamed file upload.
+ *
+ * Sinks receive the contents of uploaded files while the request is still
+ * being received, on the event loop thread, so writes should not block for
+ * long.
+ */
+class UploadSink {
+public:
+  virtual ~UploadSink() = default;
+
+  /**
+   * @brief Consumes the next bytes of the file.
+   * @param data File bytes.
+   * @return false to reject the upload with a 500 error.
+   */
+  virtual bool write(std::string_view data) = 0;
+
+  /**
+   * @brief Called once the whole file has been received.
+   * @param file Uploaded file metadata; `location` may be set by the sink.
+   * @return false to reject the upload with a 500 error.
+   */
+  virtual bool finish(UploadedFile &file) = 0;
 };
 
 /**
@@ -71,13 +234,23 @@ struct UploadedFile {
  * Encapsulates request metadata (method, headers, cookies), request body,
  * form fields, and uploaded files. Both plain text and raw binary contents
  * are supported.
+ *
+ * Headers are stored in the request's own arena, which handlers may also
+ * use for scratch `std::pmr` containers; everything allocated from it is
+ * released at once with the request. Moving a request moves its arena, so a
+ * moved-from request may only be destroyed.
  */
 struct Request {
-  std::string full_url;     ///< Full URL of the request (path + query).
-  std::string request_path; ///< Path of the request (e.g. `/users/123`).
-  std::string method;       ///< HTTP method (GET, POST, etc.).
+  RequestArena arena; ///< Arena backing headers and handler scratch memory.
+
+  std::string full_url;       ///< Full URL of the request (path + query).
+  std::string request_path;   ///< Path of the request (e.g. `/users/123`).
+  std::string query;          ///< Query string, without the leading `?`.
+  std::string method;         ///< HTTP method (GET, POST, etc.).
+  std::string version;        ///< HTTP version (e.g. `HTTP/1.1`).
+  std::string remote_address; ///< IP address of the client.
 
-  std::map<std::string, std::string> headers; ///< Map of request headers.
+  HeaderMap headers; ///< Request headers, with case-insensitive names.
   std::map<std::string, std::string>
       cookies; ///< Map of cookies parsed from the `Cookie` header.
   std::map<std::string, std::string>
@@ -85,6 +258,8 @@ struct Request {
 
   std::string contents;                   ///< Request body as plain string.
   std::vector<uint8_t> contents_in_bytes; ///< Request body as raw binary data.
+  std::shared_ptr<TempFile>
+      spooled_body; ///< Body spooled to disk (`contents` is then empty).
 
   std::map<std::string, UploadedFile>
       upload_files; ///< Uploaded files (for multipart forms).
@@ -93,15 +268,241 @@ struct Request {
    * @brief Default constructor initializes an empty HTTP request.
    */
   Request()
-      : full_url(""), request_path(""), method(""), headers(), cookies(),
-        form_fields(), contents(""), contents_in_bytes(), upload_files() {}
+      : arena(), full_url(""), request_path(""), query(""), method(""),
+        version(""), remote_address(), headers(arena.resource()), cookies(),
+        form_fields(), contents(""), contents_in_bytes(), spooled_body(),
+        upload_files() {}
+
+  /**
+   * @brief Returns a reader streaming the body, whether it was kept in
+   * memory or spooled to disk.
+   *
+   * Multipart bodies are not available this way; their parts are in
+   * `form_fields` and `upload_files`.
+   */
+  BodyReader body() const {
+    return BodyReader(this->contents, this->spooled_body);
+  }
+};
+
+/**
+ * @typedef RateLimitKey
+ * @brief Returns the key a request is rate limited by; requests with an
+ * empty key are limited by their client address. Keys and addresses never
+ * share a bucket, even when their strings are equal.
+ */
+using RateLimitKey = std::function<std::string(const Request &request)>;
+
+/**
+ * @brief Returns a rate limit key function reading a request header.
+ * @param name Header name (e.g. `X-API-Key`).
+ */
+RateLimitKey rate_limit_by_header(const std::string &name);
+
+/**
+ * @brief Returns a rate limit key function reading a request cookie.
+ * @param name Cookie name.
+ */
+RateLimitKey rate_limit_by_cookie(const std::string &name);
+
+/**
+ * @typedef UploadSinkFactory
+ * @brief Creates the sink receiving an uploaded file, or returns null to
+ * store the file the default way.
+ */
+using UploadSinkFactory = std::function<std::unique_ptr<UploadSink>(
+    const Request &request, const std::string &field,
+    const UploadedFile &file)>;
+
+/**
+ * @struct BodyReceiver
+ * @brief State of a request whose body is being received.
+ *
+ * Created once the request head has been parsed. Received bytes are decoded
+ * and stored (in memory, in temporary files or in upload sinks) as they
+ * arrive, and the request is dispatched once the body is complete.
+ */
+struct BodyReceiver {
+  Request request; ///< The request, without its body yet.
+  bool keep_alive; ///< The connection may persist after the response.
+
+  bool chunked;           ///< The body uses chunked transfer encoding.
+  ChunkedDecoder decoder; ///< Decoder of a chunked body.
+  size_t remaining;       ///< Bytes left of a `Content-Length` body.
+  size_t decoded;         ///< Decoded bytes of a chunked body so far.
+  std::unique_ptr<MultipartParser>
+      multipart; ///< Parser of a multipart body (null otherwise).
+
+  std::string part_name;  ///< Field name of the current part.
+  bool part_skipped;      ///< The current part is malformed and dropped.
+  bool part_is_file;      ///< The current part is a file.
+  std::string part_value; ///< Contents of the current form field.
+  UploadedFile part_file; ///< The current file.
+  std::unique_ptr<UploadSink> part_sink; ///< Sink of the current file.
+
+  int error_code;            ///< Status to answer with on failure.
+  std::string error_message; ///< Reason of the failure.
+
+  /**
+   * @brief Constructs the receiver of a request body.
+   * @param received Request whose head has been parsed.
+   * @param persist The connection may persist after the response.
+   */
+  BodyReceiver(Request received, bool persist)
+      : request(std::move(received)), keep_alive(persist), chunked(false),
+        decoder(), remaining(0), decoded(0), multipart(), part_name(),
+        part_skipped(false), part_is_file(false), part_value(), part_file(),
+        part_sink(), error_code(0), error_message() {}
+
+  BodyReceiver(const BodyReceiver &) = delete;
+  BodyReceiver &operator=(const BodyReceiver &) = delete;
+
+  /**
+   * @brief Records why the body was rejected, unless a reason was recorded
+   * already.
+   * @param code HTTP status code to answer with.
+   * @param message Reason of the failure.
+   * @return Always false, for use as a callback result.
+   */
+  bool fail(int code, const std::string &message) {
+    if (this->error_code == 0) {
+      this->error_code = code;
+      this->error_message = message;
+    }
+
+    return false;
+  }
+};
+
+/**
+ * @struct ResponseFile
+ * @brief A region of an open file sent as a response body.
+ *
+ * The region is written straight from the page cache to the socket with
+ * `sendfile()`, without passing through userspace. Sending never moves the
+ * descriptor offset, so one object may back any number of responses; the
+ * descriptor is closed when the last response referring to it is destroyed.
+ *
+ * Regions can be chained through `next`, each preceded by the in-memory
+ * `prefix`, to send a `multipart/byteranges` body without copying the file.
+ */
+struct ResponseFile {
+  int fd;        ///< Open file descriptor (owned unless borrowed).
+  off_t offset;  ///< Offset of the first byte to send.
+  size_t length; ///< Number of bytes to send.
+
+  std::shared_ptr<ResponseFile>
+      source; ///< File whose descriptor is borrowed, if any.
+  std::string prefix; ///< Bytes sent before the region.
+  std::shared_ptr<ResponseFile>
+      next; ///< Region sent after this one, if any.
+
+  /**
+   * @brief Constructs a file body for the given descriptor region.
+   * @param descriptor Open file descriptor, owned by the object.
+   * @param start Offset of the first byte to send.
+   * @param size Number of bytes to send.
+   */
+  ResponseFile(int descriptor, off_t start, size_t size)
+      : fd(descriptor), offset(start), length(size), source(), prefix(),
+        next() {}
+
+  /**
+   * @brief Constructs a region of a file borrowing its descriptor.
+   * @param file File kept open as long as the region exists.
+   * @param start Offset of the first byte to send.
+   * @param size Number of bytes to send.
+   */
+  ResponseFile(std::shared_ptr<ResponseFile> file, off_t start, size_t size)
+      : fd(file->fd), offset(start), length(size), source(std::move(file)),
+        prefix(), next() {}
+
+  ResponseFile(const ResponseFile &) = delete;
+  ResponseFile &operator=(const ResponseFile &) = delete;
+
+  /**
+   * @brief Destructor closes the file descriptor, unless borrowed.
+   */
+  ~ResponseFile();
+
+  /**
+   * @brief Returns the number of body bytes of the chain starting here,
+   * prefixes included.
+   */
+  size_t body_length() const;
+};
+
+/**
+ * @typedef ResponseProducer
+ * @brief Produces the body of a streamed response one chunk at a time.
+ *
+ * Called on a worker thread whenever the client is ready for more data, never
+ * concurrently for the same response. The producer appends the next chunk to
+ * `chunk` and returns false once the body is complete (the chunk it appended
+ * on that last call is still sent). Throwing aborts the response and closes
+ * the connection.
+ */
+using ResponseProducer = std::function<bool(std::string &chunk)>;
+
+/**
+ * @typedef AsyncResponseProducer
+ * @brief Coroutine variant of ResponseProducer.
+ *
+ * The returned task may suspend (e.g. on AsyncContext::scheduler) while
+ * waiting for the next chunk without holding a worker thread; `chunk`
+ * stays valid until the task completes.
+ */
+using AsyncResponseProducer =
+    std::function<Task<bool>(std::string &chunk)>;
+
+/**
+ * @struct ResponseStream
+ * @brief State of a streamed response body being sent.
+ *
+ * `producing` is only touched by the event loop thread. `started`,
+ * `finished` and `failed` are updated by the worker producing a chunk and
+ * read by the loop once that chunk has been posted.
+ */
+struct ResponseStream {
+  ResponseProducer producer;            ///< Yields the body chunks.
+  AsyncResponseProducer async_producer; ///< Or yields them asynchronously.
+  bool chunked;   ///< Chunks are framed with the chunked transfer coding.
+  bool producing; ///< A worker is producing the next chunk.
+  bool started;   ///< At least one chunk has been produced.
+  bool finished;  ///< The producer reported the end of the body.
+  bool failed;    ///< The producer threw; the response is cut short.
+
+  /**
+   * @brief Constructs the state of a response stream.
+   * @param body_producer Producer of the body chunks.
+   * @param framed Frame chunks with the chunked transfer coding; otherwise
+   * the body is delimited by closing the connection.
+   */
+  ResponseStream(ResponseProducer body_producer, bool framed)
+      : producer(std::move(body_producer)), async_producer(), chunked(framed),
+        producing(false), started(false), finished(false), failed(false) {}
+
+  /**
+   * @brief Constructs the state of an asynchronously produced stream.
+   * @param body_producer Coroutine producer of the body chunks.
+   * @param framed Frame chunks with the chunked transfer coding.
+   */
+  ResponseStream(AsyncResponseProducer body_producer, bool framed)
+      : producer(), async_producer(std::move(body_producer)), chunked(framed),
+        producing(false), started(false), finished(false), failed(false) {}
 };
 
 /**
  * @struct Response
  * @brief Represents an HTTP response sent back to the client.
  *
- * Includes status code, message, response body, headers, and cookies.
+ * Includes status code, message, response body, headers, and cookies. The
+ * body is either held in `contents`, sent from a file descriptor after the
+ * headers when `file` is set, or produced chunk by chunk when `stream` (or
+ * `async_stream`) is set. Streamed bodies are sent with
+ * `Transfer-Encoding: chunked` (or, to HTTP/1.0 clients, delimited by
+ * closing the connection), and the producer is only asked for more data
+ * while the client keeps up with it.
  */
 struct Response {
   std::map<std::string, std::string>
@@ -113,12 +514,25 @@ struct Response {
   int status_code;            ///< HTTP status code (e.g. 200, 404, 500).
   std::string status_message; ///< HTTP status message (e.g. "OK", "Not Found").
 
+  std::shared_ptr<ResponseFile>
+      file; ///< File body sent instead of `contents` when set.
+  ResponseProducer stream; ///< Body producer used instead of `contents`.
+  AsyncResponseProducer async_stream; ///< Coroutine body producer.
+  bool compress; ///< May be compressed when compression is enabled.
+
   /**
    * @brief Constructs a default 200 OK response with no body.
    */
   Response()
       : headers(), cookies(), contents(""), status_code(200),
-        status_message("OK") {}
+        status_message("OK"), file(), stream(), async_stream(),
+        compress(true) {}
+
+  /**
+   * @brief Checks whether the body is produced by `stream` or
+   * `async_stream`.
+   */
+  bool streamed() const { return this->stream || this->async_stream; }
 
   /**
    * @brief Sets or replaces an HTTP response header.
@@ -147,25 +561,234 @@ struct Response {
 using RequestHandler = std::function<Response(
     Purple::Format::DotEnv, Request, std::map<std::string, std::string>)>;
 
+/**
+ * @class RouteParams
+ * @brief Path parameters captured by the matched route.
+ *
+ * Values are views into the request path and names refer to the route, so
+ * the object must not outlive the request it was matched for.
+ */
+class RouteParams {
+private:
+  const std::vector<std::string> &names; ///< Parameter names of the route.
+  const RouteMatch &match;               ///< Captured parameter values.
+
+public:
+  /**
+   * @brief Constructs the parameters of a route match.
+   * @param path_names Parameter names of the matched route.
+   * @param route_match Result of the route lookup.
+   */
+  RouteParams(const std::vector<std::string> &path_names,
+              const RouteMatch &route_match)
+      : names(path_names), match(route_match) {}
+
+  /**
+   * @brief Returns the value of a parameter.
+   * @param name Parameter name.
+   * @return The captured value, or an empty view if it was not captured.
+   */
+  std::string_view get(std::string_view name) const;
+
+  /**
+   * @brief Checks whether a parameter captured a (non-empty) value.
+   * @param name Parameter name.
+   */
+  bool has(std::string_view name) const;
+
+  /**
+   * @brief Returns the number of parameters of the route.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Returns the name of the parameter at `index`.
+   */
+  const std::string &name(size_t index) const;
+
+  /**
+   * @brief Returns the value of the parameter at `index`.
+   */
+  std::string_view value(size_t index) const;
+};
+
+/**
+ * @struct RequestContext
+ * @brief Everything a ContextHandler gets to see of a request.
+ *
+ * The request, its path parameters and the configuration are passed by
+ * reference and stay valid for the duration of the handler call only.
+ */
+struct RequestContext {
+  const Request &request;                ///< The request being handled.
+  const RouteParams &params;             ///< Path parameters of the route.
+  const Purple::Format::DotEnv &config; ///< Configuration snapshot.
+
+  /**
+   * @brief Returns the value of a path parameter.
+   * @param name Parameter name.
+   * @return The captured value, or an empty view if it was not captured.
+   */
+  std::string_view param(std::string_view name) const {
+    return this->params.get(name);
+  }
+};
+
+/**
+ * @typedef ContextHandler
+ * @brief Function signature for request handlers taking a RequestContext.
+ *
+ * Unlike RequestHandler, nothing is copied to call the handler: the request,
+ * path parameters and configuration are all passed by reference.
+ */
+using ContextHandler = std::function<Response(const RequestContext &)>;
+
+/**
+ * @struct AsyncContext
+ * @brief RequestContext of an AsyncHandler.
+ *
+ * Unlike a RequestContext, it stays valid until the handler's task
+ * completes, across suspensions.
+ */
+struct AsyncContext : RequestContext {
+  TaskScheduler
+      &scheduler; ///< Resumes the handler after timers and channel receives.
+};
+
+/**
+ * @typedef AsyncHandler
+ * @brief Coroutine request handler.
+ *
+ * The handler returns a task which may `co_await` timers
+ * (`context.scheduler.sleep_for()`), channel values
+ * (`context.scheduler.receive()`) and other tasks. While suspended it holds
+ * no worker thread, so long polls and slow upstreams do not starve the
+ * pool; it is resumed on one of the tasklet workers.
+ */
+using AsyncHandler =
+    std::function<Task<Response>(const AsyncContext &)>;
+
+/**
+ * @struct Middleware
+ * @brief Logic run around the handlers of the routes it is attached to.
+ *
+ * `before` may fill `response` and return false to answer the request
+ * itself (e.g. a `401` or a CORS preflight), skipping the handler and the
+ * middleware after it. `after` may inspect or rewrite the response. Both
+ * run on the worker handling the request and are optional.
+ */
+struct Middleware {
+  std::function<bool(const RequestContext &context, Response &response)>
+      before; ///< Called before the handler; false short-circuits.
+  std::function<void(const RequestContext &context, Response &response)>
+      after; ///< Called with the response, in reverse registration order.
+
+  /**
+   * @brief Constructs a middleware without hooks.
+   */
+  Middleware() : before(), after() {}
+
+  /**
+   * @brief Constructs a middleware from its hooks.
+   * @param before_fn Hook called before the handler.
+   * @param after_fn Hook called with the response.
+   */
+  Middleware(
+      std::function<bool(const RequestContext &, Response &)> before_fn,
+      std::function<void(const RequestContext &, Response &)> after_fn =
+          nullptr)
+      : before(std::move(before_fn)), after(std::move(after_fn)) {}
+};
+
+/**
+ * @typedef MiddlewareChain
+ * @brief Middleware of a route, global middleware first, flattened once
+ * when the server starts.
+ */
+using MiddlewareChain = std::vector<Middleware>;
+
+/**
+ * @brief Returns a middleware answering CORS preflight requests and adding
+ * `Access-Control-Allow-Origin` to responses.
+ * @param origin Allowed origin, or `*` for any.
+ * @param methods Value of `Access-Control-Allow-Methods`.
+ * @param headers Value of `Access-Control-Allow-Headers`.
+ * @param max_age Seconds preflight responses may be cached by clients.
+ */
+Middleware cors_middleware(
+    const std::string &origin = "*",
+    const std::string &methods = "GET, POST, PUT, PATCH, DELETE, OPTIONS",
+    const std::string &headers = "Content-Type, Authorization",
+    int max_age = 600);
+
+/**
+ * @struct WebSocketHandler
+ * @brief Callbacks of a WebSocket route.
+ *
+ * Callbacks run on the tasklet workers, one at a time and in order for a
+ * given socket. Every callback is optional.
+ */
+struct WebSocketHandler {
+  std::function<void(const std::shared_ptr<WebSocket> &socket,
+                     const RequestContext &context)>
+      on_open; ///< Called once upgraded, with the upgrade request.
+  std::function<void(const std::shared_ptr<WebSocket> &socket,
+                     std::string_view message, bool binary)>
+      on_message; ///< Called with each complete (reassembled) message.
+  std::function<void(const std::shared_ptr<WebSocket> &socket, uint16_t code)>
+      on_close; ///< Called once closed, with the peer's code or 1006.
+
+  /**
+   * @brief Constructs a handler without callbacks.
+   */
+  WebSocketHandler() : on_open(), on_message(), on_close() {}
+};
+
 /**
  * @typedef RequestHandlerException
  * @brief Callback type for reporting handler or server errors.
  */
 using RequestHandlerException = std::function<void(std::string)>;
 
+/**
+ * @struct WebletLoadStats
+ * @brief Snapshot of the load of a Weblet and of the load it shed.
+ *
+ * Gauges are sampled independently of each other; counters only grow for
+ * the lifetime of the Weblet.
+ */
+struct WebletLoadStats {
+  size_t open_connections;       ///< Connections currently open.
+  size_t inflight_requests;      ///< Requests being handled.
+  size_t queued_tasks;           ///< Tasks waiting for a worker thread.
+  uint64_t rejected_connections; ///< Connections refused with a 503.
+  uint64_t rejected_requests;    ///< Requests refused with a 503.
+  uint64_t limited_requests;     ///< Requests refused with a 429.
+};
+
 /**
  * @struct Route
- * @brief Represents a registered route with regex pattern matching.
+ * @brief Represents a registered route.
  *
- * Each route maps a regular expression path pattern and extracted path
- * parameters to a request handler.
+ * Each route maps a path pattern and the names of the path parameters it
+ * captures to a request handler. Patterns are compiled into the Weblet's
+ * Router.
  */
 struct Route {
-  std::regex path_regex; ///< Compiled regex for matching request paths.
+  std::string pattern; ///< Path pattern the route was registered with.
   std::vector<std::string>
       path_names; ///< Parameter names extracted from the path.
 
-  RequestHandler handler; ///< Handler function for the route.
+  ContextHandler handler;     ///< Handler function for the route.
+  AsyncHandler async_handler; ///< Coroutine handler, used instead if set.
+  std::shared_ptr<const CachePolicy>
+      cache; ///< Response cache policy, null when not cached.
+  std::shared_ptr<const WebSocketHandler>
+      websocket; ///< WebSocket callbacks, set for WebSocket routes.
+  std::shared_ptr<SsePublisher>
+      events; ///< Event publisher, set for SSE routes.
+  std::shared_ptr<const MiddlewareChain>
+      middleware; ///< Middleware run around the handler, null when none.
 };
 
 /**
@@ -230,6 +853,14 @@ public:
  * - Dynamic shared object (DSO) module loading for handlers
  * - Custom error page handling
  * - Tasklet-based concurrency
+ *
+ * Connections are multiplexed by an edge-triggered epoll event loop which
+ * owns the listening socket and every client socket. Complete requests are
+ * handed to the `num_threads` tasklet workers for routing, and their
+ * responses are written back by the event loop without blocking.
+ *
+ * HTTP/1.1 connections are persistent unless either side sends
+ * `Connection: close`, and pipelined requests are answered in order.
  */
 class Weblet {
 public:
@@ -238,15 +869,41 @@ public:
    * @param host Hostname or IP to bind (e.g. "127.0.0.1").
    * @param port TCP port to listen on.
    * @param spa Enable Single Page Application (SPA) mode.
-   * @param num_threads Number of tasklet threads to spawn.
+   * @param num_threads Number of tasklet worker threads handling requests.
    * @param handler_exception_fn Callback for reporting exceptions.
    */
   Weblet(const std::string &host, int port, bool spa, size_t num_threads,
          RequestHandlerException handler_exception_fn)
-      : port(port), server_desc(-1), spa(spa), hostname(host), public_dir(),
-        routes(), error_handlers(), next_mod_id(1), loaded_mods(),
+      : port(port), spa(spa), hostname(host), public_dir(), routes(),
+        async_routes(false), websocket_routes(false), sse_routes(false),
+        router(), global_middleware(), route_middleware(),
+        error_handlers(), next_mod_id(1), loaded_mods(),
         handler_exception(handler_exception_fn),
-        tasklet_manager(TaskletManager(num_threads)), configuration() {}
+        tasklet_manager(TaskletManager(num_threads)),
+        scheduler(tasklet_manager),
+        configuration(std::make_shared<const Purple::Format::DotEnv>()),
+        config_mutex(),
+        keep_alive_timeout(WEBLET_KEEP_ALIVE_TIMEOUT_SECONDS),
+        header_timeout(WEBLET_HEADER_TIMEOUT_SECONDS),
+        body_timeout(WEBLET_BODY_TIMEOUT_SECONDS),
+        write_timeout(WEBLET_WRITE_TIMEOUT_SECONDS),
+        sendfile_threshold(WEBLET_SENDFILE_THRESHOLD), event_loop_count(1),
+        io_uring_enabled(false),
+        body_spool_threshold(WEBLET_BODY_SPOOL_THRESHOLD),
+        max_body_size(WEBLET_MAX_BODY_SIZE),
+        upload_directory(default_upload_directory()), upload_sink(),
+        max_connections(0), max_inflight_requests(0), max_queued_tasks(0),
+        retry_after(WEBLET_RETRY_AFTER_SECONDS), overload_response(),
+        open_connections(0), inflight_requests(0), rejected_connections(0),
+        rejected_requests(0), limited_requests(0), rate_limiter(),
+        rate_limit_key(), response_cache_size(WEBLET_RESPONSE_CACHE_SIZE),
+        response_cache_items(WEBLET_RESPONSE_CACHE_ITEMS),
+        websocket_max_message(WEBLET_WEBSOCKET_MAX_MESSAGE),
+        compression_enabled(false),
+        compression_min_size(WEBLET_COMPRESSION_MIN_SIZE),
+        compression_level(WEBLET_COMPRESSION_LEVEL), metrics_enabled(false),
+        response_cache(), static_cache(), metrics(), running(false),
+        event_loops(), loop_manager() {}
 
   /**
    * @brief Destructor stops the server and unloads modules.
@@ -255,17 +912,131 @@ public:
 
   /**
    * @brief Registers a request handler for a given path pattern.
-   * @param path_pattern Regex-style path pattern (supports `{param}` syntax).
+   *
+   * Patterns support `{param}` placeholders and a trailing `{param*}` (or
+   * `*`) wildcard capturing the rest of the path. When several patterns
+   * match, static text wins over parameters and parameters over wildcards.
+   * Malformed or duplicate patterns are reported to the exception callback.
+   *
+   * @param path_pattern Path pattern (e.g. `/users/{id}`).
+   * @param handler Handler function to process requests.
+   */
+  void handle(const std::string &path_pattern, ContextHandler handler);
+
+  /**
+   * @brief Registers a handler taking its arguments by value.
+   *
+   * The handler is adapted to a ContextHandler, copying the configuration,
+   * request and path parameters on every call. Prefer the ContextHandler
+   * overload for new code.
+   *
+   * @param path_pattern Path pattern (e.g. `/users/{id}`).
    * @param handler Handler function to process requests.
    */
   void handle(const std::string &path_pattern, RequestHandler handler);
 
+  /**
+   * @brief Registers a coroutine handler for a given path pattern.
+   *
+   * The handler is started on a tasklet worker like any other, and counts
+   * as an in-flight request until its task completes. Request bodies are
+   * fully received (or spooled) before dispatch, so reading them never
+   * suspends. Handlers still suspended when the server stops are never
+   * resumed.
+   *
+   * @param path_pattern Path pattern (e.g. `/events/{topic}`).
+   * @param handler Coroutine handler function.
+   */
+  void handle(const std::string &path_pattern, AsyncHandler handler);
+
+  /**
+   * @brief Registers a handler whose responses are cached.
+   *
+   * `GET` responses are stored serialized, keyed by path, the query
+   * parameters and request headers named by the policy, and served by the
+   * event loop without invoking the handler while fresh (`Cache-Control`
+   * `s-maxage` or `max-age`, else `policy.max_age`). Stale responses are
+   * still served during the `stale-while-revalidate` window while a single
+   * background request refreshes them, and concurrent misses of a key wait
+   * for a single handler call. Requests of a route with middleware are
+   * passed to a worker instead, which runs the before hooks, looks the
+   * response up in place of calling the handler and runs the after hooks
+   * on it; only the handler's own response is cached.
+   *
+   * @param path_pattern Path pattern (e.g. `/products/{id}`).
+   * @param handler Handler function to process requests.
+   * @param policy Cache key and freshness policy of the route.
+   */
+  void handle(const std::string &path_pattern, ContextHandler handler,
+              CachePolicy policy);
+
+  /**
+   * @brief Registers a WebSocket endpoint.
+   *
+   * `GET` requests with a valid RFC 6455 upgrade are answered with
+   * `101 Switching Protocols` by the event loop, and other requests with
+   * `426 Upgrade Required`. The upgraded connection stays on its event
+   * loop, which answers pings and the closing handshake itself; messages
+   * are reassembled from their fragments before reaching `on_message`.
+   *
+   * @param path_pattern Path pattern (e.g. `/live/{board}`).
+   * @param handler Callbacks of the endpoint.
+   */
+  void handle_websocket(const std::string &path_pattern,
+                        WebSocketHandler handler);
+
+  /**
+   * @brief Registers a Server-Sent Events endpoint.
+   *
+   * `GET` requests are answered by the event loop with a `text/event-stream`
+   * response that stays open, and the connection is subscribed to
+   * `publisher`: no worker thread is involved until it closes. A client
+   * sending `Last-Event-ID` first receives the kept events it missed.
+   *
+   * @param path_pattern Path pattern (e.g. `/events/{topic}`).
+   * @param publisher Source of the events.
+   */
+  void handle_sse(const std::string &path_pattern,
+                  std::shared_ptr<SsePublisher> publisher);
+
   /**
    * @brief Registers a public directory for serving static files.
+   *
+   * Files are served from an in-memory StaticCache with `ETag` and
+   * `Last-Modified` validators, answering conditional requests with
+   * `304 Not Modified`. Must be called before start().
+   *
    * @param public_dir Filesystem path to the public directory.
    */
   void handle_public(const std::string &public_dir);
 
+  /**
+   * @brief Adds a middleware run around every request handler, and around
+   * static files and error responses of unmatched paths.
+   *
+   * Global middleware runs before route middleware, in the order it was
+   * added. Chains are flattened once by start(), so a request costs one call
+   * per hook and no allocation. WebSocket upgrades and SSE subscriptions
+   * are answered by the event loop without running middleware; cached
+   * responses it applies to are served from within the chain instead (see
+   * handle()). Must be called before start().
+   *
+   * @param middleware Middleware to add.
+   */
+  void use(Middleware middleware);
+
+  /**
+   * @brief Adds a middleware run around the handler of one route only.
+   *
+   * The route may be registered before or after this call; patterns
+   * matching no route are reported to the exception callback by start().
+   * Must be called before start().
+   *
+   * @param path_pattern Pattern the route was registered with.
+   * @param middleware Middleware to add.
+   */
+  void use(const std::string &path_pattern, Middleware middleware);
+
   /**
    * @brief Adds a custom error handler for a specific status code.
    * @param error_code HTTP error code (e.g. 404, 500).
@@ -288,8 +1059,27 @@ public:
    */
   RequestHandler load_response(int shared_mods, std::string response_name);
 
+  /**
+   * @brief Loads a handler function taking a RequestContext from a dynamic
+   * module.
+   *
+   * The exported function must be declared with WebletDynamicContextHandler.
+   *
+   * @param shared_mods Module ID returned by add_module().
+   * @param response_name Name of the exported response function.
+   * @return A ContextHandler bound to the loaded function.
+   */
+  ContextHandler load_context_response(int shared_mods,
+                                       std::string response_name);
+
   /**
    * @brief Starts the Weblet server in asynchronous mode.
+   *
+   * Binds the listening socket and spawns the event loop. Returns as soon
+   * as the server accepts connections.
+   *
+   * @throws WebletException If the socket cannot be created, bound or
+   * registered with the event loop.
    */
   void start();
 
@@ -336,38 +1126,464 @@ public:
    */
   Purple::Format::DotEnv get_config() const;
 
+  /**
+   * @brief Retrieves the current configuration without copying it.
+   *
+   * The snapshot is immutable; set_config() installs a new one instead of
+   * modifying it, so holders of the old snapshot are unaffected.
+   *
+   * @return Shared pointer to the configuration currently bound.
+   */
+  std::shared_ptr<const Purple::Format::DotEnv> config_snapshot() const;
+
+  /**
+   * @brief Sets the idle timeout of persistent (keep-alive) connections.
+   *
+   * Connections without in-flight requests are closed once they have been
+   * idle for longer than the timeout. Must be called before start().
+   *
+   * @param seconds Idle timeout in seconds; `0` disables persistent
+   * connections so that every response is followed by a close.
+   */
+  void set_keep_alive_timeout(int seconds);
+
+  /**
+   * @brief Sets the time allowed to receive a complete request head.
+   *
+   * Counted from the first byte of the request (or from the accept for the
+   * first request of a connection), however slowly the bytes trickle in.
+   * Clients exceeding it get a `408 Request Timeout` and are disconnected.
+   *
+   * @param seconds Timeout in seconds.
+   */
+  void set_header_timeout(int seconds);
+
+  /**
+   * @brief Sets the time allowed between two reads of a request body.
+   *
+   * Clients exceeding it get a `408 Request Timeout` and are disconnected.
+   *
+   * @param seconds Timeout in seconds.
+   */
+  void set_body_timeout(int seconds);
+
+  /**
+   * @brief Sets the time allowed between two writes of a response.
+   *
+   * Clients not reading their response for that long are disconnected.
+   *
+   * @param seconds Timeout in seconds.
+   */
+  void set_write_timeout(int seconds);
+
+  /**
+   * @brief Sets the size above which static files are sent zero-copy.
+   *
+   * Files up to the threshold are inlined into the response body, larger
+   * ones are sent from their descriptor with `sendfile()`.
+   *
+   * @param bytes Threshold in bytes; `0` sends every file with `sendfile()`.
+   */
+  void set_sendfile_threshold(size_t bytes);
+
+  /**
+   * @brief Sets the number of event loop shards serving connections.
+   *
+   * Every shard runs its own event loop on its own thread, with its own
+   * listening socket bound to the same address through `SO_REUSEPORT`. The
+   * kernel spreads incoming connections across the sockets and a connection
+   * stays on the shard that accepted it, so shards share no connection
+   * state. Request handlers still run on the common tasklet pool. Must be
+   * called before start().
+   *
+   * @param count Number of shards; `0` starts one per available core.
+   */
+  void set_event_loops(size_t count);
+
+  /**
+   * @brief Selects io_uring instead of epoll to drive the event loops.
+   *
+   * Accepts (multishot where supported), reads into registered buffers and
+   * scatter-gather sends are then submitted to an io_uring instance per
+   * shard and handled as they complete. When io_uring is unavailable, either
+   * at build time or in the running kernel, Weblet silently falls back to
+   * epoll. Must be called before start().
+   *
+   * @param enabled Whether to use io_uring.
+   */
+  void set_io_uring(bool enabled);
+
+  /**
+   * @brief Sets the size above which request bodies and uploaded files are
+   * spooled to temporary files while they are received.
+   *
+   * Spooled bodies are read through Request::body(), spooled files through
+   * UploadedFile::spooled.
+   *
+   * @param bytes Threshold in bytes.
+   */
+  void set_body_spool_threshold(size_t bytes);
+
+  /**
+   * @brief Sets the largest request body accepted.
+   *
+   * Requests announcing a larger `Content-Length`, or whose chunked body
+   * grows past it, are answered with `413 Payload Too Large` and the
+   * connection is closed.
+   *
+   * @param bytes Limit in bytes; `0` accepts bodies of any size.
+   */
+  void set_max_body_size(size_t bytes);
+
+  /**
+   * @brief Sets the directory temporary body and upload files are created
+   * in (`$TMPDIR`, or `/tmp`, by default).
+   * @param directory Directory path.
+   */
+  void set_upload_directory(const std::string &directory);
+
+  /**
+   * @brief Sets the factory of sinks that uploaded files are streamed to.
+   *
+   * The factory is called on the event loop thread when a file part starts.
+   * Files for which it returns null are stored in memory or spooled to a
+   * temporary file as usual.
+   *
+   * @param factory Sink factory.
+   */
+  void set_upload_sink(UploadSinkFactory factory);
+
+  /**
+   * @brief Sets the maximum number of open connections.
+   *
+   * Connections accepted beyond the limit are answered with a
+   * `503 Service Unavailable` carrying `Retry-After` and closed at once.
+   * Must be called before start().
+   *
+   * @param count Maximum number of connections; `0` means unlimited.
+   */
+  void set_max_connections(size_t count);
+
+  /**
+   * @brief Sets the maximum number of requests being handled at once.
+   *
+   * A request is in flight from its dispatch to a worker until its handler
+   * has returned. Requests beyond the limit are answered with a pre-rendered
+   * `503 Service Unavailable` without running their handler, and their
+   * connection is closed. Must be called before start().
+   *
+   * @param count Maximum number of requests; `0` means unlimited.
+   */
+  void set_max_inflight_requests(size_t count);
+
+  /**
+   * @brief Sets the maximum number of requests waiting for a worker.
+   *
+   * Requests arriving while the tasklet queue is full are answered with a
+   * pre-rendered `503 Service Unavailable` like those exceeding
+   * set_max_inflight_requests(). Must be called before start().
+   *
+   * @param count Maximum queue length; `0` means unlimited.
+   */
+  void set_max_queued_tasks(size_t count);
+
+  /**
+   * @brief Sets the `Retry-After` delay of overload responses. Must be
+   * called before start().
+   * @param seconds Delay in seconds.
+   */
+  void set_retry_after(int seconds);
+
+  /**
+   * @brief Sets the capacity of the response cache of cached routes; least
+   * recently used responses are evicted beyond it. Must be called before
+   * start().
+   * @param bytes Maximum total size of the cached responses.
+   * @param items Maximum number of cached responses.
+   */
+  void set_response_cache_limits(size_t bytes, size_t items);
+
+  /**
+   * @brief Sets the largest WebSocket message accepted; larger messages
+   * close the connection with status 1009.
+   * @param bytes Maximum message size in bytes.
+   */
+  void set_websocket_max_message(size_t bytes);
+
+  /**
+   * @brief Enables `gzip` and `deflate` response compression.
+   *
+   * In-memory bodies of compressible types (text, JSON, JavaScript, XML...)
+   * of at least `min_size` bytes are compressed on the worker that produced
+   * them, with the coding preferred by the request's `Accept-Encoding`.
+   * Static assets are served from their `.gz` sibling when it is up to
+   * date, or else compressed once (at the best level) and cached. Files
+   * above the static cache limit and streamed bodies are sent as is, and a
+   * handler may opt a response out by clearing `Response::compress`. Must
+   * be called before start().
+   *
+   * @param min_size Smallest body compressed.
+   * @param level zlib compression level (1-9) of dynamic responses.
+   */
+  void set_compression(size_t min_size = WEBLET_COMPRESSION_MIN_SIZE,
+                       int level = WEBLET_COMPRESSION_LEVEL);
+
+  /**
+   * @brief Limits the rate of requests of each client.
+   *
+   * Every client may send `burst` requests at once, then `rate` requests per
+   * second. Requests beyond the limit are answered with
+   * `429 Too Many Requests` and a `Retry-After` header by the event loop,
+   * without running any handler. Must be called before start().
+   *
+   * @param rate Sustained number of requests per second of a client.
+   * @param burst Number of requests a client may send at once.
+   * @param key Function returning the client key of a request (see
+   * rate_limit_by_header() and rate_limit_by_cookie()); requests are keyed
+   * by client address when it is null or returns an empty key.
+   */
+  void set_rate_limit(double rate, size_t burst, RateLimitKey key = nullptr);
+
+  /**
+   * @brief Returns the current load and the number of shed connections and
+   * requests.
+   */
+  WebletLoadStats load_stats();
+
+  /**
+   * @brief Enables timing of the phases of requests.
+   *
+   * Accepting connections, reading heads and bodies, parsing, route
+   * matching, handlers and writing responses are timed with the monotonic
+   * clock and recorded, per route, into per-thread latency histograms.
+   * Requests matching no route (static files, 404s) and connection-level
+   * phases are recorded under an empty route. Unless `path` is empty, a
+   * route serving render_metrics() is registered at `path`. When metrics
+   * are not enabled, each phase costs a single branch. Must be called
+   * before start().
+   *
+   * @param path Path of the metrics endpoint, or empty for none.
+   */
+  void enable_metrics(const std::string &path = WEBLET_METRICS_PATH);
+
+  /**
+   * @brief Renders the phase latencies (p50, p99 and p999 of each route and
+   * phase) and the load statistics in the Prometheus text format.
+   */
+  std::string render_metrics();
+
 private:
+  /**
+   * @struct AsyncCall
+   * @brief A request handled by an AsyncHandler, or waiting on a cached
+   * route's response, with everything its AsyncContext refers to, kept
+   * alive until the response is complete.
+   */
+  struct AsyncCall {
+    Request request;  ///< The request being handled.
+    RouteMatch match; ///< Route match into `request`.
+    std::shared_ptr<const Purple::Format::DotEnv>
+        config;           ///< Configuration snapshot.
+    RouteParams params;   ///< Path parameters of the route.
+    AsyncContext context; ///< Context passed to the handler.
+
+    AsyncCall(Request &&handled, const Route &route,
+              std::shared_ptr<const Purple::Format::DotEnv> snapshot,
+              TaskScheduler &scheduler)
+        : request(std::move(handled)), match(), config(std::move(snapshot)),
+          params(route.path_names, this->match),
+          context{{this->request, this->params, *this->config}, scheduler} {}
+  };
+
   int port;             ///< TCP port number.
-  int server_desc;      ///< Server socket descriptor.
   bool spa;             ///< SPA mode enabled flag.
   std::string hostname; ///< Hostname or IP to bind.
 
   std::string public_dir;    ///< Directory for serving static files.
   std::vector<Route> routes; ///< Registered routes.
+  bool async_routes;         ///< Some route has an AsyncHandler.
+  bool websocket_routes;     ///< Some route is a WebSocket endpoint.
+  bool sse_routes;           ///< Some route is an SSE endpoint.
+  Router router;             ///< Radix tree indexing `routes`.
+  MiddlewareChain global_middleware; ///< Middleware of every request.
+  std::vector<std::pair<std::string, Middleware>>
+      route_middleware; ///< Middleware of single routes, by pattern.
   std::map<int, std::string> error_handlers; ///< Error handlers by code.
 
   int next_mod_id;                           ///< Next available module ID.
   std::map<int, void *> loaded_mods;         ///< Loaded dynamic modules.
   RequestHandlerException handler_exception; ///< Exception reporting callback.
   TaskletManager tasklet_manager;       ///< Tasklet manager for concurrency.
-  Purple::Format::DotEnv configuration; ///< Configuration dot environment.
+  TaskScheduler scheduler;              ///< Resumes AsyncHandlers.
+  std::shared_ptr<const Purple::Format::DotEnv>
+      configuration;               ///< Configuration snapshot.
+  mutable std::mutex config_mutex; ///< Guards replacing `configuration`.
+  int keep_alive_timeout;               ///< Keep-alive idle timeout (s).
+  int header_timeout;                   ///< Request head read timeout (s).
+  int body_timeout;                     ///< Request body read timeout (s).
+  int write_timeout;                    ///< Response write timeout (s).
+  size_t sendfile_threshold;            ///< Inline static file size limit.
+  size_t event_loop_count;              ///< Number of event loop shards.
+  bool io_uring_enabled;                ///< Prefer the io_uring backend.
+  size_t body_spool_threshold;          ///< In-memory request body limit.
+  size_t max_body_size;                 ///< Request body limit (0: none).
+  std::string upload_directory;         ///< Directory of spooled bodies.
+  UploadSinkFactory upload_sink;        ///< Factory of upload sinks.
+  size_t max_connections;               ///< Open connection limit.
+  size_t max_inflight_requests;         ///< In-flight request limit.
+  size_t max_queued_tasks;              ///< Queued request limit.
+  int retry_after;                      ///< Retry-After of 503s (s).
+  std::string overload_response;        ///< Pre-rendered 503 response.
+
+  std::atomic<size_t> open_connections;       ///< Open connection gauge.
+  std::atomic<size_t> inflight_requests;      ///< In-flight request gauge.
+  std::atomic<uint64_t> rejected_connections; ///< Shed connection count.
+  std::atomic<uint64_t> rejected_requests;    ///< Shed request count.
+  std::atomic<uint64_t> limited_requests;     ///< Rate limited count.
+  std::unique_ptr<RateLimiter> rate_limiter;  ///< Per-client rate limiter.
+  RateLimitKey rate_limit_key;                ///< Client key of requests.
+  size_t response_cache_size;                 ///< Response cache bytes.
+  size_t response_cache_items;                ///< Response cache entries.
+  size_t websocket_max_message;               ///< WebSocket message limit.
+  bool compression_enabled;                   ///< Responses may be compressed.
+  size_t compression_min_size;                ///< Smallest body compressed.
+  int compression_level;                      ///< Dynamic compression level.
+  bool metrics_enabled;                       ///< Phases are timed.
+
+  std::unique_ptr<ResponseCache> response_cache; ///< Cached route responses.
+  std::unique_ptr<StaticCache> static_cache;     ///< Public directory cache.
+  std::unique_ptr<WebletMetrics> metrics;        ///< Phase latencies.
+  std::atomic<bool> running;                     ///< Event loop running flag.
+  std::vector<std::unique_ptr<EventLoop>>
+      event_loops; ///< Epoll reactor state of each shard.
+  std::unique_ptr<TaskletManager> loop_manager; ///< Event loop threads.
+
+  int open_listener();
+  bool setup_io_uring(EventLoop &loop, bool watch);
+
+  void run_event_loop(EventLoop &loop);
+  void run_uring_loop(EventLoop &loop);
+  void handle_uring_completion(EventLoop &loop,
+                               const IoUringCompletion &completion);
+  void accept_clients(EventLoop &loop);
+  void add_connection(EventLoop &loop, int fd, const sockaddr_storage *peer);
+  void reject_connection(int fd);
+  void service_connection(EventLoop &loop, int fd, uint32_t events);
+  void deliver_completions(EventLoop &loop);
+  void close_connection(EventLoop &loop, int fd);
+  void arm_timeout(EventLoop &loop, Connection &connection);
+  long long connection_deadline(Connection &connection, long long now);
+  void expire_timeouts(EventLoop &loop);
 
-  ssize_t safe_send(int sock_desc, const std::string &data, int flags = 0);
+  bool read_connection(EventLoop &loop, Connection &connection);
+  bool receive_input(EventLoop &loop, Connection &connection,
+                     bool peer_closed);
+  bool pipeline_full(const Connection &connection);
+  bool input_full(const Connection &connection);
+  bool resume_input(EventLoop &loop, Connection &connection);
+  void arm_receive(EventLoop &loop, Connection &connection);
+  void start_read(EventLoop &loop, Connection &connection);
+  void release_buffer(EventLoop &loop, Connection &connection);
+  bool process_input(EventLoop &loop, Connection &connection);
+  bool flush_connection(EventLoop &loop, Connection &connection);
+  void produce_chunk(EventLoop &loop, Connection &connection);
+  bool write_output(EventLoop &loop, Connection &connection);
+  void consume_output(Connection &connection, size_t written);
+  bool send_file_body(EventLoop &loop, Connection &connection);
+  void queue_error(Connection &connection, Response response);
+  void reject_request(Connection &connection);
+  bool limit_request(Connection &connection, const Request &request,
+                     bool keep_alive);
+  void dispatch_request(EventLoop &loop, Connection &connection,
+                        Request request, bool keep_alive);
+  bool submit_request(EventLoop *target, uint64_t id, int fd,
+                      uint64_t sequence, bool keep_alive, Request request,
+                      std::string cache_key,
+                      std::shared_ptr<const CachePolicy> policy);
+  void run_request(EventLoop *target, uint64_t id, int fd, uint64_t sequence,
+                   bool keep_alive, Request &request,
+                   const std::string &cache_key,
+                   const std::shared_ptr<const CachePolicy> &policy);
+  void run_async_request(EventLoop *target, uint64_t id, int fd,
+                         uint64_t sequence, bool keep_alive, Request &request,
+                         const Route &route, const std::string &cache_key,
+                         const std::shared_ptr<const CachePolicy> &policy);
+  void run_cached_request(EventLoop *target, uint64_t id, int fd,
+                          uint64_t sequence, bool keep_alive, Request &request,
+                          const Route &route,
+                          const std::shared_ptr<const CachePolicy> &policy);
+  Response invoke_handler(const Route &route, const RequestContext &context);
+  void finish_request(EventLoop *target, uint64_t id, int fd,
+                      uint64_t sequence, bool keep_alive,
+                      const Request &request, const std::string &cache_key,
+                      const std::shared_ptr<const CachePolicy> &policy,
+                      Response response);
+  void compress_response(const Request &request, Response &response);
+  void report_exception(const std::string &context,
+                        std::exception_ptr error);
+  void post_chunk(EventLoop *target, uint64_t id, int fd,
+                  std::shared_ptr<ResponseStream> stream, std::string chunk,
+                  bool more);
 
-  ssize_t safe_recv_to_vec(int sock_desc, std::vector<char> &buffer,
-                           size_t len_to_read, int flags = 0);
+  bool serve_cached(EventLoop &loop, Connection &connection, Request &request,
+                    bool keep_alive, std::string &cache_key,
+                    std::shared_ptr<const CachePolicy> &policy);
+  void complete_cache(const std::string &key,
+                      std::shared_ptr<const CachedResponse> entry);
+  std::string build_cache_key(const CachePolicy &policy,
+                              const Request &request);
+  std::shared_ptr<const CachedResponse>
+  cache_entry(const CachePolicy &policy, const Response &response);
+  Response cached_response(const CachedResponse &entry);
+  std::string cached_head(const CachedResponse &entry, bool keep_alive,
+                          const std::string &version);
 
-  void parse_req_headers(std::istringstream &headers_stream, Request &request);
+  bool upgrade_websocket(EventLoop &loop, Connection &connection,
+                         Request &request);
+  void receive_frames(Connection &connection);
+  void close_websocket(Connection &connection, uint16_t code);
+  void release_websocket(Connection &connection);
+  void deliver_frames(EventLoop &loop);
+
+  bool subscribe_events(EventLoop &loop, Connection &connection,
+                        Request &request);
+  void release_event_stream(EventLoop &loop, Connection &connection);
+
+  bool wants_keep_alive(const Request &request) const;
+
+  void build_request(const HttpRequestHead &head, Request &request);
+  bool start_body(Connection &connection, Request request, bool keep_alive,
+                  size_t content_length, bool chunked);
+  bool receive_body(Connection &connection);
+  bool store_body(BodyReceiver &receiver, std::string_view data);
+  bool begin_part(BodyReceiver &receiver, const HeaderMap &headers);
+  bool store_part(BodyReceiver &receiver, std::string_view data);
+  bool end_part(BodyReceiver &receiver);
+  void parse_request_body(Request &request);
+
+  void parse_cookies(std::string_view header, Request &request);
   void parse_url_enc_data(const std::string &body, Request &request);
 
-  void parse_multipart_data(const std::string &body,
-                            const std::string &boundary, Request &request);
+  static std::string default_upload_directory();
 
-  std::string build_response_str(const Response &response);
-  void handle_client(int client_socket_fd);
+  std::string build_response_head(const Response &response);
 
-  Response route_request(const Request &request);
-  Response serve_static(const std::string &filepath);
+  size_t trace_head(Connection &connection, const Request &request,
+                    long long parse_started);
+  Response route_request(const Request &request, size_t &route_slot);
+  Response serve_public(const Request &request);
+  void build_middleware();
+  bool enter_middleware(const MiddlewareChain *chain,
+                        const RequestContext &context, Response &response,
+                        size_t &entered);
+  void leave_middleware(const MiddlewareChain *chain, size_t entered,
+                        const RequestContext &context, Response &response);
+  Response serve_asset(const Request &request, const StaticAsset &asset);
+  bool is_not_modified(const Request &request, const StaticAsset &asset);
+  bool if_range_matches(const Request &request, const StaticAsset &asset);
+  void serve_ranges(const StaticAsset &asset,
+                    const std::vector<std::pair<size_t, size_t>> &ranges,
+                    Response &response);
   Response handle_error(int error_code, const std::string &message = "");
 };
 
@@ -385,6 +1601,22 @@ private:
  */
 #define WebletDynamicHandler extern "C" struct Response
 
+/**
+ * @def WebletDynamicContextHandler
+ * @brief Macro for declaring dynamic ContextHandler functions in shared
+ * modules, loaded with Weblet::load_context_response().
+ *
+ * Example:
+ * @code
+ * WebletDynamicContextHandler my_handler(const RequestContext &context) {
+ *   Response res;
+ *   res.contents = "Hello, " + std::string(context.param("name"));
+ *   return res;
+ * }
+ * @endcode
+ */
+#define WebletDynamicContextHandler extern "C" struct Response
+
 } // namespace Purple::Net
 
 #endif
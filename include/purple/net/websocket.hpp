@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file websocket.hpp
+ * @author Nathanne Isip <nathanneisip@gmail.com>
+ * @brief Provides the RFC 6455 WebSocket framing and the handles Weblet
+ * gives to WebSocket handlers.
+ *
+ * Upgraded connections stay on the event loop that accepted them: frames are
+ * parsed (and unmasked in place) in its receive buffer, and outgoing frames
+ * are queued to it by any thread. A broadcast frame is encoded once and the
+ * same buffer is queued to every subscriber.
+ */
+#ifndef PURPLE_NET_WEBSOCKET_HPP
+#define PURPLE_NET_WEBSOCKET_HPP
+
+#include <purple/concurrent/tasklet.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Purple::Net {
+
+struct EventLoop;
+
+/**
+ * @def WEBLET_WEBSOCKET_MAX_MESSAGE
+ * @brief Default maximum size of a received WebSocket message, fragments
+ * included (16 MB).
+ */
+#define WEBLET_WEBSOCKET_MAX_MESSAGE 16777216
+
+/**
+ * @def WEBLET_WEBSOCKET_MAX_QUEUED_FRAMES
+ * @brief Number of outgoing frames a WebSocket may have waiting for its
+ * socket before it is dropped as too slow (1024).
+ */
+#define WEBLET_WEBSOCKET_MAX_QUEUED_FRAMES 1024
+
+/**
+ * @enum WebSocketOpcode
+ * @brief Frame opcodes defined by RFC 6455.
+ */
+enum class WebSocketOpcode : uint8_t {
+  Continuation = 0x0, ///< Next fragment of a message.
+  Text = 0x1,         ///< First frame of a UTF-8 text message.
+  Binary = 0x2,       ///< First frame of a binary message.
+  Close = 0x8,        ///< Closing handshake.
+  Ping = 0x9,         ///< Keep-alive probe, answered with a pong.
+  Pong = 0xA          ///< Answer to a ping.
+};
+
+/**
+ * @enum WebSocketParseStatus
+ * @brief Outcome of parsing the frame at the start of a buffer.
+ */
+enum class WebSocketParseStatus {
+  Incomplete, ///< More bytes are needed.
+  Complete,   ///< A frame has been parsed.
+  Error       ///< The frame breaks the protocol; see `close_code`.
+};
+
+/**
+ * @struct WebSocketFrame
+ * @brief A frame parsed from a client.
+ */
+struct WebSocketFrame {
+  bool fin;                 ///< Last fragment of its message.
+  WebSocketOpcode opcode;   ///< Frame opcode.
+  std::string_view payload; ///< Unmasked payload, in the parsed buffer.
+  size_t length;            ///< Size of the whole frame in the buffer.
+  uint16_t close_code;      ///< Close code to fail the connection with.
+};
+
+/**
+ * @brief Parses (and unmasks in place) the client frame at `offset`.
+ *
+ * Client frames must be masked, carry no extension bits and, for control
+ * frames, be unfragmented with at most 125 bytes of payload.
+ *
+ * @param buffer Received bytes.
+ * @param offset Offset of the frame within `buffer`.
+ * @param max_payload Largest payload accepted.
+ * @param frame Receives the frame.
+ * @return The outcome of parsing.
+ */
+WebSocketParseStatus parse_websocket_frame(std::string &buffer, size_t offset,
+                                           size_t max_payload,
+                                           WebSocketFrame &frame);
+
+/**
+ * @brief Unmasks (or masks) a payload in place.
+ *
+ * Works on 16 (SSE2) or 8 bytes at a time, then byte by byte for the tail.
+ *
+ * @param data Payload bytes.
+ * @param length Number of bytes.
+ * @param mask Masking key of the frame.
+ */
+void websocket_unmask(char *data, size_t length, const unsigned char mask[4]);
+
+/**
+ * @brief Encodes an unmasked, unfragmented server frame.
+ * @param opcode Frame opcode.
+ * @param payload Frame payload.
+ * @return The serialized frame.
+ */
+std::string encode_websocket_frame(WebSocketOpcode opcode,
+                                   std::string_view payload);
+
+/**
+ * @brief Encodes a close frame.
+ * @param code Close status code, or 1005 to send no status.
+ * @param reason UTF-8 reason, at most 123 bytes are kept.
+ * @return The serialized frame.
+ */
+std::string encode_websocket_close(uint16_t code, std::string_view reason);
+
+/**
+ * @brief Checks that a text message is well-formed UTF-8.
+ *
+ * Rejects overlong encodings, surrogates and code points beyond U+10FFFF,
+ * as RFC 6455 requires of text messages.
+ */
+bool is_valid_utf8(std::string_view text);
+
+/**
+ * @brief Computes the `Sec-WebSocket-Accept` value answering a key.
+ * @param key Value of the `Sec-WebSocket-Key` request header.
+ * @return Base64 of the SHA-1 of the key and the RFC 6455 GUID.
+ */
+std::string websocket_accept_key(std::string_view key);
+
+/**
+ * @class WebSocket
+ * @brief Handle of an upgraded connection, usable from any thread.
+ *
+ * Sending only queues the frame to the connection's event loop. Once the
+ * connection is closed (by either side) or the server stops, the handle is
+ * detached and sending fails.
+ */
+class WebSocket : public std::enable_shared_from_this<WebSocket> {
+private:
+  mutable std::mutex mutex; ///< Guards the fields below.
+  EventLoop *loop;          ///< Loop of the connection, null once detached.
+  uint64_t connection_id;   ///< Identifier of the connection.
+  int fd;                   ///< Descriptor of the connection.
+  std::string remote;       ///< IP address of the peer.
+  std::deque<std::function<void()>>
+      events;       ///< Handler calls waiting to run, in order.
+  bool dispatching; ///< A worker is running `events`.
+
+  void drain(Purple::Concurrent::TaskletManager *workers);
+
+public:
+  /**
+   * @brief Constructs the handle of an upgraded connection.
+   * @param event_loop Loop owning the connection.
+   * @param identifier Identifier of the connection.
+   * @param descriptor Descriptor of the connection.
+   * @param address IP address of the peer.
+   */
+  WebSocket(EventLoop *event_loop, uint64_t identifier, int descriptor,
+            std::string address);
+
+  WebSocket(const WebSocket &) = delete;
+  WebSocket &operator=(const WebSocket &) = delete;
+
+  /**
+   * @brief Sends a message.
+   * @param message Message payload.
+   * @param binary Send a binary rather than a text message.
+   * @return false if the connection is closed.
+   */
+  bool send(std::string_view message, bool binary = false);
+
+  /**
+   * @brief Queues an already encoded frame.
+   * @param frame Serialized frame, possibly shared with other sockets.
+   * @param closing The frame is a close frame; the connection is closed
+   * once the peer answers it (or the write timeout expires).
+   * @return false if the connection is closed.
+   */
+  bool send_frame(std::shared_ptr<const std::string> frame,
+                  bool closing = false);
+
+  /**
+   * @brief Starts the closing handshake.
+   * @param code Close status code.
+   * @param reason UTF-8 reason.
+   */
+  void close(uint16_t code = 1000, std::string_view reason = "");
+
+  /**
+   * @brief Checks whether the connection is still open.
+   */
+  bool is_open() const;
+
+  /**
+   * @brief Returns the IP address of the peer.
+   */
+  const std::string &remote_address() const;
+
+  /**
+   * @brief Returns the loop, identifier and descriptor of the connection,
+   * or a null loop once detached.
+   */
+  EventLoop *target(uint64_t &identifier, int &descriptor) const;
+
+  /**
+   * @brief Detaches the handle from its closed connection.
+   *
+   * Called by the event loop before the connection is destroyed.
+   */
+  void detach();
+
+  /**
+   * @brief Runs a handler call on a worker, after the calls dispatched
+   * before it on this socket have returned.
+   * @param workers Tasklet workers.
+   * @param event Handler call.
+   */
+  void dispatch(Purple::Concurrent::TaskletManager &workers,
+                std::function<void()> event);
+};
+
+/**
+ * @class WebSocketGroup
+ * @brief Thread-safe set of sockets receiving the same messages.
+ *
+ * Sockets are removed automatically once found closed.
+ */
+class WebSocketGroup {
+private:
+  std::mutex mutex; ///< Guards `members`.
+  std::vector<std::shared_ptr<WebSocket>> members; ///< Subscribed sockets.
+
+public:
+  WebSocketGroup() : mutex(), members() {}
+
+  WebSocketGroup(const WebSocketGroup &) = delete;
+  WebSocketGroup &operator=(const WebSocketGroup &) = delete;
+
+  /**
+   * @brief Adds a socket to the group.
+   */
+  void add(std::shared_ptr<WebSocket> socket);
+
+  /**
+   * @brief Removes a socket from the group.
+   */
+  void remove(const std::shared_ptr<WebSocket> &socket);
+
+  /**
+   * @brief Returns the number of sockets in the group.
+   */
+  size_t size();
+
+  /**
+   * @brief Sends a message to every socket of the group.
+   *
+   * The frame is encoded once and handed to each event loop in a single
+   * wake-up, along with the list of its connections to queue it to.
+   *
+   * @param message Message payload.
+   * @param binary Send a binary rather than a text message.
+   * @return Number of sockets the message was queued to.
+   */
+  size_t broadcast(std::string_view message, bool binary = false);
+};
+
+/**
+ * @struct WebSocketSession
+ * @brief Event loop side state of an upgraded connection.
+ */
+struct WebSocketSession {
+  std::shared_ptr<WebSocket> socket; ///< Handle given to the handler.
+  std::function<void(std::string message, bool binary)>
+      on_message; ///< Dispatches a complete message.
+  std::function<void(uint16_t code)>
+      on_close;                   ///< Dispatches the end of the connection.
+  std::string message;            ///< Fragments of the current message.
+  WebSocketOpcode message_opcode; ///< Opcode of its first fragment.
+  bool fragmented;                ///< A fragmented message is incomplete.
+  bool close_sent;                ///< A close frame has been queued.
+  uint16_t close_code;            ///< Code the peer closed with.
+
+  /**
+   * @brief Constructs the state of a freshly upgraded connection.
+   * @param handle Handle given to the handler.
+   */
+  explicit WebSocketSession(std::shared_ptr<WebSocket> handle)
+      : socket(std::move(handle)), on_message(), on_close(), message(),
+        message_opcode(WebSocketOpcode::Text), fragmented(false),
+        close_sent(false), close_code(1006) {}
+};
+
+/**
+ * @struct FrameDelivery
+ * @brief Encoded frame (or SSE event) queued to connections of an event
+ * loop by any thread.
+ */
+struct FrameDelivery {
+  std::shared_ptr<const std::string> frame; ///< Serialized frame.
+  std::vector<std::pair<int, uint64_t>>
+      targets;  ///< Descriptor and identifier of each connection.
+  bool closing; ///< The frame starts the closing handshake.
+};
+
+} // namespace Purple::Net
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/concurrent/task.hpp>
+
+namespace Purple::Concurrent {
+
+TaskScheduler::TaskScheduler(TaskletManager &workers)
+    : state(std::make_shared<State>(&workers)), timer_started(false),
+      timer_thread() {}
+
+TaskScheduler::~TaskScheduler() { this->stop(); }
+
+void TaskScheduler::resume(std::coroutine_handle<> handle) {
+  TaskScheduler::resume(this->state, handle);
+}
+
+void TaskScheduler::resume_after(Clock::duration delay,
+                                 std::coroutine_handle<> handle) {
+  {
+    std::lock_guard<std::mutex> lock(this->state->mutex);
+    if (this->state->stopped)
+      return;
+    else if (!this->timer_started) {
+      this->timer_thread = std::thread(TaskScheduler::run_timers, this->state);
+      this->timer_started = true;
+    }
+
+    this->state->timers.emplace(Clock::now() + delay, handle);
+  }
+
+  this->state->condition.notify_one();
+}
+
+void TaskScheduler::start() {
+  this->stop();
+
+  this->state = std::make_shared<State>(this->state->workers);
+  this->timer_started = false;
+}
+
+void TaskScheduler::stop() {
+  {
+    std::lock_guard<std::mutex> lock(this->state->mutex);
+    this->state->stopped = true;
+    this->state->timers.clear();
+  }
+
+  this->state->condition.notify_all();
+  if (this->timer_thread.joinable())
+    this->timer_thread.join();
+}
+
+void TaskScheduler::resume(const std::shared_ptr<State> &state,
+                           std::coroutine_handle<> handle) {
+  std::lock_guard<std::mutex> lock(state->mutex);
+
+  if (!state->stopped)
+    state->workers->go([handle] { handle.resume(); });
+}
+
+void TaskScheduler::run_timers(std::shared_ptr<State> state) {
+  std::unique_lock<std::mutex> lock(state->mutex);
+
+  while (!state->stopped) {
+    if (state->timers.empty()) {
+      state->condition.wait(lock);
+      continue;
+    }
+
+    auto next = state->timers.begin();
+    if (next->first > Clock::now()) {
+      state->condition.wait_until(lock, next->first);
+      continue;
+    }
+
+    std::coroutine_handle<> handle = next->second;
+    state->timers.erase(next);
+    state->workers->go([handle] { handle.resume(); });
+  }
+}
+
+} // namespace Purple::Concurrent
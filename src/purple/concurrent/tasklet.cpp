@@ -98,6 +98,25 @@ void TaskletManager::go(std::function<void()> task) {
   this->condition.notify_one();
 }
 
+bool TaskletManager::try_go(std::function<void()> task, size_t max_queued) {
+  {
+    std::unique_lock<std::mutex> lock(this->queue_mutex);
+    if (max_queued != 0 && this->tasks.size() >= max_queued)
+      return false;
+
+    this->tasks.push(std::move(task));
+    this->active_tasks_count.fetch_add(1, std::memory_order_release);
+  }
+
+  this->condition.notify_one();
+  return true;
+}
+
+size_t TaskletManager::queued_tasks() {
+  std::unique_lock<std::mutex> lock(this->queue_mutex);
+  return this->tasks.size();
+}
+
 void TaskletManager::wait_for_completion() {
   std::unique_lock<std::mutex> lock(this->queue_mutex);
 
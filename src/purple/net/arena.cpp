@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/arena.hpp>
+
+namespace Purple::Net {
+
+RequestArena::RequestArena() : block(std::make_unique<Block>()) {}
+
+RequestArena::RequestArena(const RequestArena &) : block() {}
+
+RequestArena &RequestArena::operator=(const RequestArena &) { return *this; }
+
+RequestArena &RequestArena::operator=(RequestArena &&) noexcept {
+  return *this;
+}
+
+std::pmr::memory_resource *RequestArena::resource() const {
+  return this->block ? &this->block->resource
+                     : std::pmr::get_default_resource();
+}
+
+} // namespace Purple::Net
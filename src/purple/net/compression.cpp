@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/compression.hpp>
+#include <purple/net/http_parser.hpp>
+
+#include <charconv>
+#include <cstdint>
+
+namespace Purple::Net {
+
+Compressor::Compressor(ContentCoding content_coding)
+    : stream(), coding(content_coding), level(0), initialized(false) {}
+
+Compressor::~Compressor() {
+  if (this->initialized)
+    deflateEnd(&this->stream);
+}
+
+bool Compressor::compress(std::string_view input, int compression_level,
+                          std::string &output) {
+  if (!this->initialized) {
+    if (deflateInit2(&this->stream, compression_level, Z_DEFLATED,
+                     this->coding == ContentCoding::Gzip ? 15 + 16 : 15, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+      return false;
+
+    this->initialized = true;
+    this->level = compression_level;
+  } else if (deflateReset(&this->stream) != Z_OK)
+    return false;
+  else if (this->level != compression_level) {
+    if (deflateParams(&this->stream, compression_level, Z_DEFAULT_STRATEGY) !=
+        Z_OK)
+      return false;
+
+    this->level = compression_level;
+  }
+
+  output.resize(deflateBound(&this->stream, input.size()));
+  this->stream.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+  this->stream.avail_in = static_cast<uInt>(input.size());
+  this->stream.next_out = reinterpret_cast<Bytef *>(output.data());
+  this->stream.avail_out = static_cast<uInt>(output.size());
+
+  if (deflate(&this->stream, Z_FINISH) != Z_STREAM_END) {
+    output.clear();
+    return false;
+  }
+
+  output.resize(this->stream.total_out);
+  return output.size() < input.size();
+}
+
+bool compress_body(ContentCoding coding, std::string_view input, int level,
+                   std::string &output) {
+  thread_local Compressor gzip(ContentCoding::Gzip);
+  thread_local Compressor deflate(ContentCoding::Deflate);
+
+  if (coding == ContentCoding::Identity || input.size() > UINT32_MAX / 2)
+    return false;
+
+  return (coding == ContentCoding::Gzip ? gzip : deflate)
+      .compress(input, level, output);
+}
+
+ContentCoding negotiate_coding(std::string_view accept_encoding) {
+  double gzip = -1, deflate = -1, any = -1;
+
+  while (!accept_encoding.empty()) {
+    size_t separator = accept_encoding.find(',');
+    std::string_view item = accept_encoding.substr(0, separator);
+
+    accept_encoding = separator == std::string_view::npos
+                          ? std::string_view()
+                          : accept_encoding.substr(separator + 1);
+
+    size_t parameters = item.find(';');
+    std::string_view token = item.substr(0, parameters);
+    double quality = 1;
+
+    while (!token.empty() && (token.front() == ' ' || token.front() == '\t'))
+      token.remove_prefix(1);
+    while (!token.empty() && (token.back() == ' ' || token.back() == '\t'))
+      token.remove_suffix(1);
+
+    if (parameters != std::string_view::npos) {
+      std::string_view parameter = item.substr(parameters + 1);
+      size_t q = parameter.find("q=");
+
+      if (q != std::string_view::npos)
+        std::from_chars(parameter.data() + q + 2,
+                        parameter.data() + parameter.size(), quality);
+    }
+
+    if (iequals(token, "gzip") || iequals(token, "x-gzip"))
+      gzip = quality;
+    else if (iequals(token, "deflate"))
+      deflate = quality;
+    else if (token == "*")
+      any = quality;
+  }
+
+  if (gzip < 0)
+    gzip = any;
+  if (deflate < 0)
+    deflate = any;
+
+  if (gzip > 0 && gzip >= deflate)
+    return ContentCoding::Gzip;
+  else if (deflate > 0)
+    return ContentCoding::Deflate;
+
+  return ContentCoding::Identity;
+}
+
+const char *coding_name(ContentCoding coding) {
+  switch (coding) {
+  case ContentCoding::Gzip:
+    return "gzip";
+  case ContentCoding::Deflate:
+    return "deflate";
+  default:
+    return "identity";
+  }
+}
+
+bool is_compressible_type(std::string_view content_type) {
+  content_type = content_type.substr(0, content_type.find(';'));
+
+  if (content_type.rfind("text/", 0) == 0)
+    return true;
+
+  for (std::string_view suffix :
+       {"json", "javascript", "ecmascript", "xml", "wasm"})
+    if (content_type.size() >= suffix.size() &&
+        content_type.substr(content_type.size() - suffix.size()) == suffix)
+      return true;
+
+  return content_type == "image/x-icon" || content_type == "font/ttf" ||
+         content_type == "font/otf" ||
+         content_type == "application/x-font-ttf";
+}
+
+} // namespace Purple::Net
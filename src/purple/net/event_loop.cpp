@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/event_loop.hpp>
+#include <purple/net/weblet.hpp>
+
+#include <chrono>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Purple::Net {
+
+Connection::Connection(int descriptor, uint64_t identifier, long long now)
+    : fd(descriptor), id(identifier), peer(), remote_address(), input(),
+      parser(),
+      body(), output(),
+      output_offset(0), output_file(), file_offset(0), file_remaining(0),
+      output_stream(), pending(), first_sequence(0), websocket(),
+      event_stream(), close_after_write(false), last_active(now),
+      request_started(now), timer_deadline(0), trace(), ops_in_flight(0),
+      closing(false), receiving(false), awaiting_buffer(false),
+      read_paused(false), sending(false), receive_buffer(-1), send_iov(),
+      send_message() {}
+
+Connection::~Connection() {
+  if (this->fd != -1)
+    close(this->fd);
+}
+
+const std::string &Connection::peer_address() {
+  if (!this->remote_address.empty())
+    return this->remote_address;
+
+  socklen_t length = sizeof(this->peer);
+  if (this->peer.ss_family == AF_UNSPEC &&
+      getpeername(this->fd, reinterpret_cast<sockaddr *>(&this->peer),
+                  &length) == -1)
+    return this->remote_address;
+
+  char address[INET6_ADDRSTRLEN] = "";
+  if (this->peer.ss_family == AF_INET)
+    inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in *>(&this->peer)->sin_addr,
+              address, sizeof(address));
+  else if (this->peer.ss_family == AF_INET6)
+    inet_ntop(AF_INET6,
+              &reinterpret_cast<sockaddr_in6 *>(&this->peer)->sin6_addr,
+              address, sizeof(address));
+
+  this->remote_address = address;
+  return this->remote_address;
+}
+
+EventLoop::~EventLoop() {
+  this->connections.clear();
+
+  if (this->listen_desc != -1)
+    close(this->listen_desc);
+
+  if (this->wake_desc != -1)
+    close(this->wake_desc);
+
+  if (this->epoll_desc != -1)
+    close(this->epoll_desc);
+}
+
+void EventLoop::post(Completion completion) {
+  {
+    std::lock_guard<std::mutex> lock(this->completions_mutex);
+    this->completions.push_back(std::move(completion));
+  }
+
+  this->wake();
+}
+
+std::vector<Completion> EventLoop::take_completions() {
+  std::vector<Completion> taken;
+
+  std::lock_guard<std::mutex> lock(this->completions_mutex);
+  taken.swap(this->completions);
+
+  return taken;
+}
+
+void EventLoop::post_frames(FrameDelivery delivery) {
+  {
+    std::lock_guard<std::mutex> lock(this->completions_mutex);
+    this->frames.push_back(std::move(delivery));
+  }
+
+  this->wake();
+}
+
+std::vector<FrameDelivery> EventLoop::take_frames() {
+  std::vector<FrameDelivery> taken;
+
+  std::lock_guard<std::mutex> lock(this->completions_mutex);
+  taken.swap(this->frames);
+
+  return taken;
+}
+
+void EventLoop::wake() {
+  if (this->wake_desc != -1)
+    eventfd_write(this->wake_desc, 1);
+}
+
+void EventLoop::drain_wake() {
+  eventfd_t value;
+  while (eventfd_read(this->wake_desc, &value) == 0)
+    ;
+}
+
+long long monotonic_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+long long monotonic_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace Purple::Net
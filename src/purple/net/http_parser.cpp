@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/http_parser.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Purple::Net {
+
+static inline char lower_ascii(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+static inline bool is_token_char(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') ||
+         (c != '\0' && std::strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+}
+
+bool iequals(std::string_view left, std::string_view right) {
+  if (left.size() != right.size())
+    return false;
+
+  for (size_t i = 0; i < left.size(); i++)
+    if (lower_ascii(left[i]) != lower_ascii(right[i]))
+      return false;
+
+  return true;
+}
+
+bool CaseInsensitiveLess::operator()(std::string_view left,
+                                     std::string_view right) const {
+  return std::lexicographical_compare(
+      left.begin(), left.end(), right.begin(), right.end(),
+      [](char a, char b) { return lower_ascii(a) < lower_ascii(b); });
+}
+
+const HttpHeader *HttpRequestHead::find(std::string_view name) const {
+  for (size_t i = 0; i < this->header_count; i++)
+    if (iequals(this->headers[i].name, name))
+      return &this->headers[i];
+
+  return nullptr;
+}
+
+std::string_view HttpRequestHead::header(std::string_view name) const {
+  const HttpHeader *found = this->find(name);
+  return found ? found->value : std::string_view();
+}
+
+HttpParseStatus HttpParser::parse(std::string_view buffer) {
+  while (this->state == State::RequestLine ||
+         this->state == State::HeaderLine) {
+    size_t line_end = buffer.find('\n', this->scanned);
+
+    if (line_end == std::string_view::npos) {
+      this->scanned = buffer.size();
+
+      if (buffer.size() >= WEBLET_MAX_HEADER_SIZE)
+        this->fail("Request headers too large");
+
+      return this->state == State::Error ? HttpParseStatus::Error
+                                         : HttpParseStatus::Incomplete;
+    }
+
+    size_t line_start = this->line_start;
+    std::string_view line = buffer.substr(line_start, line_end - line_start);
+
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+
+    this->line_start = this->scanned = line_end + 1;
+    if (this->line_start > WEBLET_MAX_HEADER_SIZE) {
+      this->fail("Request headers too large");
+      break;
+    }
+
+    if (this->state == State::RequestLine) {
+      if (line.empty() && this->method.length == 0)
+        continue;
+      else if (this->parse_request_line(line, line_start))
+        this->state = State::HeaderLine;
+    } else if (line.empty())
+      this->state = State::Complete;
+    else
+      this->parse_header_line(line, line_start);
+  }
+
+  if (this->state == State::Error)
+    return HttpParseStatus::Error;
+
+  if (this->parsed.method.data() != buffer.data() + this->method.offset) {
+    auto view = [&buffer](const Span &span) {
+      return buffer.substr(span.offset, span.length);
+    };
+
+    this->parsed.method = view(this->method);
+    this->parsed.target = view(this->target);
+    this->parsed.version = view(this->version);
+
+    size_t query_start = this->parsed.target.find('?');
+    this->parsed.path = this->parsed.target.substr(0, query_start);
+    this->parsed.query = query_start == std::string_view::npos
+                             ? std::string_view()
+                             : this->parsed.target.substr(query_start + 1);
+
+    for (size_t i = 0; i < this->field_count; i++)
+      this->parsed.headers[i] = {view(this->fields[i].first),
+                                 view(this->fields[i].second)};
+    this->parsed.header_count = this->field_count;
+
+    if (!this->check_framing())
+      return HttpParseStatus::Error;
+  }
+
+  return HttpParseStatus::Complete;
+}
+
+const HttpRequestHead &HttpParser::head() const { return this->parsed; }
+
+size_t HttpParser::head_length() const { return this->line_start; }
+
+const char *HttpParser::error() const { return this->error_message; }
+
+void HttpParser::reset() {
+  this->state = State::RequestLine;
+  this->line_start = this->scanned = 0;
+  this->error_message = "";
+  this->method = this->target = this->version = {0, 0};
+  this->field_count = 0;
+  this->parsed = HttpRequestHead();
+}
+
+bool HttpParser::parse_request_line(std::string_view line, size_t offset) {
+  size_t method_end = line.find(' ');
+  size_t target_end = method_end == std::string_view::npos
+                          ? std::string_view::npos
+                          : line.find(' ', method_end + 1);
+
+  if (target_end == std::string_view::npos || method_end == 0 ||
+      target_end == method_end + 1) {
+    this->fail("Malformed request line");
+    return false;
+  }
+
+  std::string_view method_view = line.substr(0, method_end);
+  std::string_view version_view = line.substr(target_end + 1);
+
+  if (!std::all_of(method_view.begin(), method_view.end(), is_token_char) ||
+      version_view.substr(0, 7) != "HTTP/1." || version_view.size() != 8) {
+    this->fail("Malformed request line");
+    return false;
+  }
+
+  this->method = {offset, method_end};
+  this->target = {offset + method_end + 1, target_end - method_end - 1};
+  this->version = {offset + target_end + 1, version_view.size()};
+
+  return true;
+}
+
+bool HttpParser::parse_header_line(std::string_view line, size_t offset) {
+  size_t colon = line.find(':');
+
+  if (colon == std::string_view::npos || colon == 0 ||
+      !std::all_of(line.begin(), line.begin() + colon, is_token_char)) {
+    this->fail("Malformed header field");
+    return false;
+  } else if (this->field_count == WEBLET_MAX_HEADERS) {
+    this->fail("Too many header fields");
+    return false;
+  }
+
+  size_t value_start = colon + 1;
+  size_t value_end = line.size();
+
+  while (value_start < value_end &&
+         (line[value_start] == ' ' || line[value_start] == '\t'))
+    value_start++;
+
+  while (value_end > value_start &&
+         (line[value_end - 1] == ' ' || line[value_end - 1] == '\t'))
+    value_end--;
+
+  this->fields[this->field_count++] = {
+      {offset, colon}, {offset + value_start, value_end - value_start}};
+  return true;
+}
+
+bool HttpParser::check_framing() {
+  const HttpHeader *length = nullptr;
+  bool transfer_encoding = false;
+
+  for (size_t i = 0; i < this->parsed.header_count; i++) {
+    const HttpHeader &field = this->parsed.headers[i];
+
+    if (iequals(field.name, "Transfer-Encoding"))
+      transfer_encoding = true;
+    else if (!iequals(field.name, "Content-Length"))
+      continue;
+    else if (!length)
+      length = &field;
+    else if (length->value != field.value) {
+      this->fail("Conflicting Content-Length headers");
+      return false;
+    }
+  }
+
+  if (length && transfer_encoding) {
+    this->fail("Both Transfer-Encoding and Content-Length present");
+    return false;
+  }
+
+  return true;
+}
+
+void HttpParser::fail(const char *message) {
+  this->state = State::Error;
+  this->error_message = message;
+}
+
+} // namespace Purple::Net
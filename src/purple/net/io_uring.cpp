@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/io_uring.hpp>
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+
+// IORING_OP_READ and the other operations used here appeared in Linux 5.6.
+#ifdef IORING_FEAT_RW_CUR_POS
+#define PURPLE_HAS_IO_URING 1
+#endif
+
+// Added in 5.19; older kernels reject multishot accepts at runtime instead.
+#ifndef IORING_ACCEPT_MULTISHOT
+#define IORING_ACCEPT_MULTISHOT (1U << 0)
+#endif
+#ifndef IORING_CQE_F_MORE
+#define IORING_CQE_F_MORE (1U << 1)
+#endif
+#endif
+
+namespace Purple::Net {
+
+#ifdef PURPLE_HAS_IO_URING
+
+template <typename T> static inline T *ring_field(void *ring, uint32_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+IoUring::~IoUring() {
+  if (this->sqes)
+    munmap(this->sqes, this->sqes_size);
+
+  if (this->cq_ring && this->cq_ring != this->sq_ring)
+    munmap(this->cq_ring, this->cq_ring_size);
+
+  if (this->sq_ring)
+    munmap(this->sq_ring, this->sq_ring_size);
+
+  if (this->ring_desc != -1)
+    close(this->ring_desc);
+}
+
+bool IoUring::setup(unsigned entries) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = entries * 4;
+
+  this->ring_desc =
+      static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (this->ring_desc < 0) {
+    this->ring_desc = -1;
+    return false;
+  }
+
+  this->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  this->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap && this->cq_ring_size > this->sq_ring_size)
+    this->sq_ring_size = this->cq_ring_size;
+
+  this->sq_ring =
+      mmap(nullptr, this->sq_ring_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, this->ring_desc, IORING_OFF_SQ_RING);
+  if (this->sq_ring == MAP_FAILED) {
+    this->sq_ring = nullptr;
+    return false;
+  }
+
+  if (single_mmap)
+    this->cq_ring = this->sq_ring;
+  else {
+    this->cq_ring =
+        mmap(nullptr, this->cq_ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, this->ring_desc, IORING_OFF_CQ_RING);
+
+    if (this->cq_ring == MAP_FAILED) {
+      this->cq_ring = nullptr;
+      return false;
+    }
+  }
+
+  this->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  this->sqes = mmap(nullptr, this->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, this->ring_desc,
+                    IORING_OFF_SQES);
+  if (this->sqes == MAP_FAILED) {
+    this->sqes = nullptr;
+    return false;
+  }
+
+  this->sq_tail = ring_field<unsigned>(this->sq_ring, params.sq_off.tail);
+  this->sq_mask = ring_field<unsigned>(this->sq_ring, params.sq_off.ring_mask);
+  this->sq_array = ring_field<unsigned>(this->sq_ring, params.sq_off.array);
+  this->cq_head = ring_field<unsigned>(this->cq_ring, params.cq_off.head);
+  this->cq_tail = ring_field<unsigned>(this->cq_ring, params.cq_off.tail);
+  this->cq_mask = ring_field<unsigned>(this->cq_ring, params.cq_off.ring_mask);
+  this->cqes = ring_field<void>(this->cq_ring, params.cq_off.cqes);
+  this->sq_entries = params.sq_entries;
+
+  return true;
+}
+
+bool IoUring::register_buffers(const struct iovec *buffers, unsigned count) {
+  return syscall(__NR_io_uring_register, this->ring_desc,
+                 IORING_REGISTER_BUFFERS, buffers, count) == 0;
+}
+
+void IoUring::prepare_accept_multishot(int fd, uint64_t user_data) {
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(
+      this->next_entry(IORING_OP_ACCEPT, fd, user_data));
+
+  entry->ioprio = IORING_ACCEPT_MULTISHOT;
+  entry->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+}
+
+void IoUring::prepare_accept(int fd, sockaddr *address, socklen_t *length,
+                             uint64_t user_data) {
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(
+      this->next_entry(IORING_OP_ACCEPT, fd, user_data));
+
+  entry->addr = reinterpret_cast<uintptr_t>(address);
+  entry->addr2 = reinterpret_cast<uintptr_t>(length);
+  entry->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+}
+
+void IoUring::prepare_read_fixed(int fd, char *buffer, size_t length,
+                                 unsigned index, uint64_t user_data) {
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(
+      this->next_entry(IORING_OP_READ_FIXED, fd, user_data));
+
+  entry->addr = reinterpret_cast<uintptr_t>(buffer);
+  entry->len = static_cast<uint32_t>(length);
+  entry->buf_index = static_cast<uint16_t>(index);
+}
+
+void IoUring::prepare_read(int fd, void *buffer, size_t length,
+                           uint64_t user_data) {
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(
+      this->next_entry(IORING_OP_READ, fd, user_data));
+
+  entry->addr = reinterpret_cast<uintptr_t>(buffer);
+  entry->len = static_cast<uint32_t>(length);
+}
+
+void IoUring::prepare_sendmsg(int fd, const struct msghdr *message,
+                              uint64_t user_data) {
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(
+      this->next_entry(IORING_OP_SENDMSG, fd, user_data));
+
+  entry->addr = reinterpret_cast<uintptr_t>(message);
+  entry->len = 1;
+  entry->msg_flags = MSG_NOSIGNAL;
+}
+
+void IoUring::prepare_poll(int fd, uint32_t events, uint64_t user_data) {
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(
+      this->next_entry(IORING_OP_POLL_ADD, fd, user_data));
+
+  entry->poll32_events = events;
+}
+
+void IoUring::prepare_timeout(long long milliseconds, uint64_t user_data) {
+  this->timeout_spec[0] = milliseconds / 1000;
+  this->timeout_spec[1] = (milliseconds % 1000) * 1000000;
+
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(
+      this->next_entry(IORING_OP_TIMEOUT, -1, user_data));
+
+  entry->addr = reinterpret_cast<uintptr_t>(this->timeout_spec);
+  entry->len = 1;
+}
+
+bool IoUring::submit_and_wait(unsigned wait_count) {
+  int result = this->enter(wait_count);
+  return result >= 0 || result == -EINTR || result == -EBUSY ||
+         result == -EAGAIN || result == -ETIME;
+}
+
+void IoUring::reap(std::vector<IoUringCompletion> &completions) {
+  unsigned head = *this->cq_head;
+  unsigned tail = __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE);
+  io_uring_cqe *entries = static_cast<io_uring_cqe *>(this->cqes);
+
+  for (; head != tail; head++) {
+    const io_uring_cqe &entry = entries[head & *this->cq_mask];
+    completions.push_back({entry.user_data, entry.res,
+                           (entry.flags & IORING_CQE_F_MORE) != 0});
+  }
+
+  __atomic_store_n(this->cq_head, head, __ATOMIC_RELEASE);
+}
+
+void *IoUring::next_entry(uint8_t opcode, int fd, uint64_t user_data) {
+  if (this->queued == this->sq_entries)
+    this->enter(0);
+
+  unsigned tail = *this->sq_tail;
+  unsigned index = tail & *this->sq_mask;
+  io_uring_sqe *entry = static_cast<io_uring_sqe *>(this->sqes) + index;
+
+  std::memset(entry, 0, sizeof(*entry));
+  entry->opcode = opcode;
+  entry->fd = fd;
+  entry->user_data = user_data;
+
+  this->sq_array[index] = index;
+  __atomic_store_n(this->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  this->queued++;
+
+  return entry;
+}
+
+int IoUring::enter(unsigned wait_count) {
+  long result = syscall(__NR_io_uring_enter, this->ring_desc, this->queued,
+                        wait_count, wait_count ? IORING_ENTER_GETEVENTS : 0,
+                        nullptr, 0);
+
+  if (result < 0)
+    return -errno;
+
+  this->queued -= static_cast<unsigned>(result);
+  return static_cast<int>(result);
+}
+
+#else
+
+IoUring::~IoUring() {}
+
+bool IoUring::setup(unsigned) { return false; }
+
+bool IoUring::register_buffers(const struct iovec *, unsigned) {
+  return false;
+}
+
+void IoUring::prepare_accept_multishot(int, uint64_t) {}
+
+void IoUring::prepare_accept(int, sockaddr *, socklen_t *, uint64_t) {}
+
+void IoUring::prepare_read_fixed(int, char *, size_t, unsigned, uint64_t) {}
+
+void IoUring::prepare_read(int, void *, size_t, uint64_t) {}
+
+void IoUring::prepare_sendmsg(int, const struct msghdr *, uint64_t) {}
+
+void IoUring::prepare_poll(int, uint32_t, uint64_t) {}
+
+void IoUring::prepare_timeout(long long, uint64_t) {}
+
+bool IoUring::submit_and_wait(unsigned) { return false; }
+
+void IoUring::reap(std::vector<IoUringCompletion> &) {}
+
+void *IoUring::next_entry(uint8_t, int, uint64_t) { return nullptr; }
+
+int IoUring::enter(unsigned) { return -ENOSYS; }
+
+#endif
+
+} // namespace Purple::Net
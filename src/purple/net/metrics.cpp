@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/metrics.hpp>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Purple::Net {
+
+static std::atomic<uint64_t> next_generation(1);
+
+static std::string escape_label(const std::string &value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+
+  for (char c : value)
+    if (c == '\\' || c == '"')
+      escaped.append(1, '\\').append(1, c);
+    else if (c == '\n')
+      escaped.append("\\n");
+    else
+      escaped.push_back(c);
+
+  return escaped;
+}
+
+static std::string format_seconds(uint64_t nanos) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.9g",
+                static_cast<double>(nanos) / 1e9);
+
+  return buffer;
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+  std::atomic<uint64_t> &count = this->counts[bucket_of(nanos)];
+
+  count.store(count.load(std::memory_order_relaxed) + 1,
+              std::memory_order_relaxed);
+  this->sum.store(this->sum.load(std::memory_order_relaxed) + nanos,
+                  std::memory_order_relaxed);
+}
+
+void LatencyHistogram::merge_into(std::vector<uint64_t> &merged,
+                                  uint64_t &total) const {
+  for (size_t bucket = 0; bucket < bucket_count; bucket++)
+    merged[bucket] += this->counts[bucket].load(std::memory_order_relaxed);
+
+  total += this->sum.load(std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t nanos) {
+  if (nanos < (1ULL << sub_bucket_bits))
+    return nanos;
+
+  unsigned exponent = 63 - __builtin_clzll(nanos);
+  if (exponent > max_exponent)
+    return bucket_count - 1;
+
+  return ((exponent - sub_bucket_bits + 1) << sub_bucket_bits) +
+         ((nanos >> (exponent - sub_bucket_bits)) &
+          ((1ULL << sub_bucket_bits) - 1));
+}
+
+uint64_t LatencyHistogram::bucket_limit(size_t bucket) {
+  if (bucket < (1ULL << sub_bucket_bits))
+    return bucket;
+
+  unsigned exponent = (bucket >> sub_bucket_bits) + sub_bucket_bits - 1;
+  uint64_t mantissa = bucket & ((1ULL << sub_bucket_bits) - 1);
+
+  return (((1ULL << sub_bucket_bits) + mantissa + 1)
+          << (exponent - sub_bucket_bits)) -
+         1;
+}
+
+WebletMetrics::ThreadHistograms::ThreadHistograms(std::thread::id thread,
+                                                  size_t slot_count)
+    : owner(thread),
+      slots(std::make_unique<std::atomic<LatencyHistogram *>[]>(slot_count)),
+      count(slot_count) {}
+
+WebletMetrics::ThreadHistograms::~ThreadHistograms() {
+  for (size_t slot = 0; slot < this->count; slot++)
+    delete this->slots[slot].load();
+}
+
+WebletMetrics::WebletMetrics(std::vector<std::string> route_labels)
+    : routes(std::move(route_labels)), generation(next_generation++),
+      mutex(), threads() {}
+
+WebletMetrics::ThreadHistograms &WebletMetrics::local() {
+  thread_local uint64_t cached_generation = 0;
+  thread_local ThreadHistograms *cached = nullptr;
+
+  if (cached_generation == this->generation)
+    return *cached;
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  std::thread::id self = std::this_thread::get_id();
+
+  cached = nullptr;
+  for (const std::unique_ptr<ThreadHistograms> &thread : this->threads)
+    if (thread->owner == self)
+      cached = thread.get();
+
+  if (!cached) {
+    this->threads.push_back(std::make_unique<ThreadHistograms>(
+        self, this->routes.size() * phase_count));
+    cached = this->threads.back().get();
+  }
+
+  cached_generation = this->generation;
+  return *cached;
+}
+
+void WebletMetrics::record(size_t route, RequestPhase phase, uint64_t nanos) {
+  std::atomic<LatencyHistogram *> &slot =
+      this->local().slots[route * phase_count + static_cast<size_t>(phase)];
+  LatencyHistogram *histogram = slot.load(std::memory_order_relaxed);
+
+  if (!histogram) {
+    histogram = new LatencyHistogram();
+    slot.store(histogram, std::memory_order_release);
+  }
+
+  histogram->record(nanos);
+}
+
+std::string WebletMetrics::render() const {
+  std::string text =
+      "# HELP weblet_phase_seconds Time spent in each phase of requests.\n"
+      "# TYPE weblet_phase_seconds summary\n";
+  std::vector<uint64_t> merged(LatencyHistogram::bucket_count);
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  for (size_t route = 0; route < this->routes.size(); route++)
+    for (size_t phase = 0; phase < phase_count; phase++) {
+      uint64_t total = 0, count = 0;
+      std::fill(merged.begin(), merged.end(), 0);
+
+      for (const std::unique_ptr<ThreadHistograms> &thread : this->threads) {
+        const LatencyHistogram *histogram =
+            thread->slots[route * phase_count + phase].load(
+                std::memory_order_acquire);
+
+        if (histogram)
+          histogram->merge_into(merged, total);
+      }
+
+      for (uint64_t samples : merged)
+        count += samples;
+      if (count == 0)
+        continue;
+
+      std::string labels =
+          "{route=\"" + escape_label(this->routes[route]) + "\",phase=\"" +
+          phase_name(static_cast<RequestPhase>(phase)) + "\"";
+
+      for (double quantile : {0.5, 0.99, 0.999}) {
+        uint64_t rank = static_cast<uint64_t>(quantile * count);
+        uint64_t seen = 0;
+        size_t bucket = 0;
+
+        if (rank < quantile * count || rank == 0)
+          rank++;
+        while ((seen += merged[bucket]) < rank)
+          bucket++;
+
+        char label[32];
+        std::snprintf(label, sizeof(label), ",quantile=\"%g\"}", quantile);
+        text.append("weblet_phase_seconds")
+            .append(labels)
+            .append(label)
+            .append(" ")
+            .append(format_seconds(LatencyHistogram::bucket_limit(bucket)))
+            .append("\n");
+      }
+
+      text.append("weblet_phase_seconds_sum")
+          .append(labels)
+          .append("} ")
+          .append(format_seconds(total))
+          .append("\nweblet_phase_seconds_count")
+          .append(labels)
+          .append("} ")
+          .append(std::to_string(count))
+          .append("\n");
+    }
+
+  return text;
+}
+
+const char *phase_name(RequestPhase phase) {
+  switch (phase) {
+  case RequestPhase::Accept:
+    return "accept";
+  case RequestPhase::HeaderRead:
+    return "header_read";
+  case RequestPhase::BodyRead:
+    return "body_read";
+  case RequestPhase::Parse:
+    return "parse";
+  case RequestPhase::RouteMatch:
+    return "route_match";
+  case RequestPhase::Handler:
+    return "handler";
+  default:
+    return "send";
+  }
+}
+
+} // namespace Purple::Net
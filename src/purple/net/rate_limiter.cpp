@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/event_loop.hpp>
+#include <purple/net/rate_limiter.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+namespace Purple::Net {
+
+RateLimiter::RateLimiter(double rate, size_t burst)
+    : interval(static_cast<long long>(1e9 / std::max(rate, 1e-9))),
+      tolerance(this->interval * static_cast<long long>(std::max<size_t>(
+                                     burst, 1))),
+      shards(std::make_unique<Shard[]>(WEBLET_RATE_LIMIT_SHARDS)) {}
+
+bool RateLimiter::allow(std::string_view key, long long &retry_after) {
+  long long now = monotonic_ns();
+  Shard &shard =
+      this->shards[KeyHash()(key) % WEBLET_RATE_LIMIT_SHARDS];
+
+  long long next_sweep = shard.next_sweep.load(std::memory_order_relaxed);
+  if (now >= next_sweep &&
+      shard.next_sweep.compare_exchange_strong(
+          next_sweep, now + WEBLET_RATE_LIMIT_SWEEP_MS * 1000000LL,
+          std::memory_order_relaxed))
+    this->sweep(shard, now);
+
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto found = shard.buckets.find(key);
+
+    if (found != shard.buckets.end())
+      return this->update(found->second, now, retry_after);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  auto [bucket, inserted] = shard.buckets.try_emplace(std::string(key), 0);
+
+  return this->update(bucket->second, now, retry_after);
+}
+
+size_t RateLimiter::size() {
+  size_t count = 0;
+
+  for (size_t i = 0; i < WEBLET_RATE_LIMIT_SHARDS; i++) {
+    std::shared_lock<std::shared_mutex> lock(this->shards[i].mutex);
+    count += this->shards[i].buckets.size();
+  }
+
+  return count;
+}
+
+bool RateLimiter::update(std::atomic<long long> &bucket, long long now,
+                         long long &retry_after) {
+  long long arrival = bucket.load(std::memory_order_relaxed);
+
+  while (true) {
+    long long next = std::max(arrival, now) + this->interval;
+
+    if (next - now > this->tolerance) {
+      retry_after = (next - now - this->tolerance + 999999) / 1000000;
+      return false;
+    } else if (bucket.compare_exchange_weak(arrival, next,
+                                            std::memory_order_relaxed))
+      return true;
+  }
+}
+
+void RateLimiter::sweep(Shard &shard, long long now) {
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+  for (auto bucket = shard.buckets.begin(); bucket != shard.buckets.end();) {
+    if (bucket->second.load(std::memory_order_relaxed) <= now)
+      bucket = shard.buckets.erase(bucket);
+    else
+      ++bucket;
+  }
+}
+
+} // namespace Purple::Net
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/request_body.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Purple::Net {
+
+TempFile::~TempFile() {
+  close(this->fd);
+  unlink(this->path.c_str());
+}
+
+std::shared_ptr<TempFile> TempFile::create(const std::string &directory) {
+  std::string path_template = directory + "/weblet-XXXXXX";
+  std::vector<char> path(path_template.begin(), path_template.end());
+  path.push_back('\0');
+
+  int descriptor = mkostemp(path.data(), O_CLOEXEC);
+  if (descriptor == -1)
+    return nullptr;
+
+  return std::make_shared<TempFile>(descriptor, std::string(path.data()));
+}
+
+bool TempFile::write(std::string_view data) {
+  while (!data.empty()) {
+    ssize_t written = ::write(this->fd, data.data(), data.size());
+
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+
+      return false;
+    }
+
+    data.remove_prefix(written);
+    this->length += written;
+  }
+
+  return true;
+}
+
+size_t TempFile::read(char *buffer, size_t size, size_t offset) const {
+  while (true) {
+    ssize_t bytes_read = pread(this->fd, buffer, size, offset);
+
+    if (bytes_read >= 0)
+      return static_cast<size_t>(bytes_read);
+    else if (errno != EINTR)
+      return 0;
+  }
+}
+
+const std::string &TempFile::file_path() const { return this->path; }
+
+size_t TempFile::size() const { return this->length; }
+
+size_t BodyReader::size() const {
+  return this->file ? this->file->size() : this->memory.size();
+}
+
+size_t BodyReader::read(char *buffer, size_t length) {
+  size_t bytes_read = 0;
+
+  if (this->file)
+    bytes_read = this->file->read(buffer, length, this->position);
+  else if (this->position < this->memory.size()) {
+    bytes_read = std::min(length, this->memory.size() - this->position);
+    std::memcpy(buffer, this->memory.data() + this->position, bytes_read);
+  }
+
+  this->position += bytes_read;
+  return bytes_read;
+}
+
+bool BodyReader::read_chunk(std::string &chunk, size_t max_length) {
+  chunk.resize(std::min(max_length, this->size() - this->position));
+  chunk.resize(this->read(chunk.data(), chunk.size()));
+
+  return !chunk.empty();
+}
+
+HttpParseStatus ChunkedDecoder::next(std::string_view input, size_t &consumed,
+                                     std::string_view &data) {
+  consumed = 0;
+  data = std::string_view();
+
+  if (this->state == State::Size || this->state == State::Trailer) {
+    size_t line_end = input.find('\n');
+
+    if (line_end == std::string_view::npos) {
+      if (input.size() > WEBLET_MAX_HEADER_SIZE)
+        this->state = State::Error;
+
+      return this->state == State::Error ? HttpParseStatus::Error
+                                         : HttpParseStatus::Incomplete;
+    }
+
+    std::string_view line = input.substr(0, line_end);
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+
+    consumed = line_end + 1;
+    if (this->state == State::Trailer) {
+      if (line.empty())
+        this->state = State::Complete;
+
+      return this->state == State::Complete ? HttpParseStatus::Complete
+                                            : HttpParseStatus::Incomplete;
+    }
+
+    size_t size = 0, digits = 0;
+    for (char c : line) {
+      int value = (c >= '0' && c <= '9')   ? c - '0'
+                  : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                  : (c >= 'A' && c <= 'F') ? c - 'A' + 10
+                                           : -1;
+
+      if (value < 0)
+        break;
+      else if (size > (SIZE_MAX >> 4)) {
+        this->state = State::Error;
+        return HttpParseStatus::Error;
+      }
+
+      size = (size << 4) | static_cast<size_t>(value);
+      digits++;
+    }
+
+    if (digits == 0) {
+      this->state = State::Error;
+      return HttpParseStatus::Error;
+    }
+
+    this->remaining = size;
+    this->state = size == 0 ? State::Trailer : State::Data;
+  } else if (this->state == State::Data) {
+    consumed = std::min(this->remaining, input.size());
+    data = input.substr(0, consumed);
+
+    this->remaining -= consumed;
+    if (this->remaining == 0)
+      this->state = State::DataEnd;
+  } else if (this->state == State::DataEnd) {
+    if (input.size() < 2)
+      return HttpParseStatus::Incomplete;
+    else if (input.substr(0, 2) != "\r\n") {
+      this->state = State::Error;
+      return HttpParseStatus::Error;
+    }
+
+    consumed = 2;
+    this->state = State::Size;
+  } else if (this->state == State::Error)
+    return HttpParseStatus::Error;
+  else
+    return HttpParseStatus::Complete;
+
+  return HttpParseStatus::Incomplete;
+}
+
+bool MultipartParser::feed(std::string_view data) {
+  if (this->state == State::Preamble && this->pending.empty())
+    this->pending = "\r\n";
+
+  this->pending.append(data);
+  std::string_view view(this->pending);
+
+  while (this->state != State::Complete && this->state != State::Error) {
+    if (this->state == State::Preamble) {
+      size_t found = view.find(this->delimiter);
+
+      if (found == std::string_view::npos) {
+        view.remove_prefix(
+            view.size() - std::min(view.size(), this->delimiter.size() - 1));
+        break;
+      }
+
+      view.remove_prefix(found + this->delimiter.size());
+      this->state = State::Boundary;
+    } else if (this->state == State::Boundary) {
+      if (view.size() < 2)
+        break;
+      else if (view.substr(0, 2) == "--")
+        this->state = State::Complete;
+      else if (view.substr(0, 2) == "\r\n") {
+        view.remove_prefix(2);
+        this->state = State::Headers;
+      } else
+        this->state = State::Error;
+    } else if (this->state == State::Headers) {
+      size_t headers_end = view.find("\r\n\r\n");
+      HeaderMap headers;
+
+      if (headers_end == std::string_view::npos) {
+        if (view.size() > WEBLET_MAX_HEADER_SIZE)
+          this->state = State::Error;
+
+        break;
+      }
+
+      std::string_view block = view.substr(0, headers_end + 2);
+      while (!block.empty()) {
+        size_t line_end = block.find("\r\n");
+        std::string_view line = block.substr(0, line_end);
+        size_t colon = line.find(':');
+
+        if (colon != std::string_view::npos) {
+          std::string_view value = line.substr(colon + 1);
+
+          while (!value.empty() &&
+                 (value.front() == ' ' || value.front() == '\t'))
+            value.remove_prefix(1);
+
+          auto [field, inserted] =
+              headers.emplace(line.substr(0, colon), value);
+
+          if (!inserted)
+            field->second = value;
+        }
+
+        block.remove_prefix(line_end + 2);
+      }
+
+      view.remove_prefix(headers_end + 4);
+      this->state = this->part_begin(headers) ? State::Data : State::Error;
+    } else {
+      size_t found = view.find(this->delimiter);
+      size_t available =
+          found != std::string_view::npos
+              ? found
+              : view.size() - std::min(view.size(), this->delimiter.size() - 1);
+
+      if (available > 0 && !this->part_data(view.substr(0, available))) {
+        this->state = State::Error;
+        break;
+      }
+
+      view.remove_prefix(available);
+      if (found == std::string_view::npos)
+        break;
+
+      view.remove_prefix(this->delimiter.size());
+      this->state = this->part_end() ? State::Boundary : State::Error;
+    }
+  }
+
+  this->pending.erase(0, this->pending.size() - view.size());
+  return this->state != State::Error;
+}
+
+bool MultipartParser::complete() const {
+  return this->state == State::Complete;
+}
+
+bool header_parameter(std::string_view header, std::string_view name,
+                      std::string &value) {
+  while (!header.empty()) {
+    size_t separator = header.find(';');
+    std::string_view parameter = header.substr(0, separator);
+
+    header = separator == std::string_view::npos
+                 ? std::string_view()
+                 : header.substr(separator + 1);
+
+    while (!parameter.empty() && parameter.front() == ' ')
+      parameter.remove_prefix(1);
+
+    size_t equals = parameter.find('=');
+    if (equals == std::string_view::npos ||
+        !iequals(parameter.substr(0, equals), name))
+      continue;
+
+    std::string_view raw = parameter.substr(equals + 1);
+    if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"')
+      raw = raw.substr(1, raw.size() - 2);
+
+    value = std::string(raw);
+    return true;
+  }
+
+  return false;
+}
+
+} // namespace Purple::Net
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/response_cache.hpp>
+
+namespace Purple::Net {
+
+ResponseCache::ResponseCache(size_t max_bytes, size_t max_items)
+    : entries(max_bytes, max_items), filling_mutex(), filling() {}
+
+std::vector<CacheWaiter>
+ResponseCache::complete(const std::string &key,
+                        std::shared_ptr<const CachedResponse> entry) {
+  std::lock_guard<std::mutex> lock(this->filling_mutex);
+
+  if (entry)
+    this->entries.put(
+        key, entry, (entry->stale_until - entry->stored_at) / 1000 + 1,
+        key.size() + entry->head.size() + entry->body.size() +
+            sizeof(CachedResponse));
+
+  std::vector<CacheWaiter> waiters;
+  auto pending = this->filling.find(key);
+
+  if (pending != this->filling.end()) {
+    waiters.swap(pending->second);
+    this->filling.erase(pending);
+  }
+
+  return waiters;
+}
+
+} // namespace Purple::Net
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/router.hpp>
+
+#include <cctype>
+
+namespace Purple::Net {
+
+bool Router::insert(std::string_view pattern, size_t route,
+                    std::vector<std::string> &param_names) {
+  struct Token {
+    enum { Static, Param, Wildcard } kind;
+    std::string_view text;
+  };
+
+  std::vector<Token> tokens;
+  param_names.clear();
+
+  for (size_t pos = 0; pos < pattern.size();) {
+    if (pattern[pos] == '*' && pos + 1 == pattern.size()) {
+      if (!tokens.empty() && tokens.back().kind != Token::Static)
+        return false;
+
+      tokens.push_back({Token::Wildcard, "*"});
+      break;
+    } else if (pattern[pos] != '{') {
+      size_t end = pattern.find('{', pos);
+      if (end == std::string_view::npos)
+        end = pattern.back() == '*' ? pattern.size() - 1 : pattern.size();
+
+      tokens.push_back({Token::Static, pattern.substr(pos, end - pos)});
+      pos = end;
+      continue;
+    }
+
+    size_t close = pattern.find('}', pos);
+    if (close == std::string_view::npos)
+      return false;
+
+    std::string_view name = pattern.substr(pos + 1, close - pos - 1);
+    bool wildcard = !name.empty() && name.back() == '*';
+
+    if (wildcard)
+      name.remove_suffix(1);
+
+    if (name.empty() || (wildcard && close + 1 != pattern.size()))
+      return false;
+
+    for (char c : name)
+      if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+        return false;
+
+    if (!tokens.empty() && tokens.back().kind != Token::Static)
+      return false;
+
+    tokens.push_back({wildcard ? Token::Wildcard : Token::Param, name});
+    pos = close + 1;
+  }
+
+  for (const Token &token : tokens)
+    if (token.kind != Token::Static)
+      param_names.emplace_back(token.text);
+
+  if (param_names.size() > WEBLET_MAX_ROUTE_PARAMS)
+    return false;
+
+  Node *node = &this->root, *param = nullptr;
+  for (const Token &token : tokens) {
+    std::unique_ptr<Node> *slot = nullptr;
+
+    if (token.kind == Token::Static) {
+      if (param && token.text.front() != '/') {
+        if (param->delimiter != '/' && param->delimiter != token.text.front())
+          return false;
+        param->delimiter = token.text.front();
+      }
+
+      node = this->insert_static(node, token.text);
+      param = nullptr;
+      continue;
+    } else if (token.kind == Token::Param)
+      slot = &node->param;
+    else
+      slot = &node->wildcard;
+
+    if (!*slot)
+      *slot = std::make_unique<Node>();
+    node = param = slot->get();
+  }
+
+  if (node->route != std::string::npos)
+    return false;
+
+  node->route = route;
+  return true;
+}
+
+bool Router::match(std::string_view path, RouteMatch &match) const {
+  match.param_count = 0;
+  return this->match_node(this->root, path, match);
+}
+
+Router::Node *Router::insert_static(Node *node, std::string_view text) {
+  while (!text.empty()) {
+    size_t index = node->indices.find(text.front());
+
+    if (index == std::string::npos) {
+      std::unique_ptr<Node> child = std::make_unique<Node>();
+      child->prefix = std::string(text);
+
+      node->indices.push_back(text.front());
+      node->children.push_back(std::move(child));
+
+      return node->children.back().get();
+    }
+
+    Node *child = node->children[index].get();
+    size_t common = 0;
+
+    while (common < text.size() && common < child->prefix.size() &&
+           text[common] == child->prefix[common])
+      common++;
+
+    if (common < child->prefix.size()) {
+      std::unique_ptr<Node> split = std::make_unique<Node>();
+      split->prefix = child->prefix.substr(0, common);
+      child->prefix.erase(0, common);
+
+      split->indices.push_back(child->prefix.front());
+      split->children.push_back(std::move(node->children[index]));
+      node->children[index] = std::move(split);
+
+      child = node->children[index].get();
+    }
+
+    text.remove_prefix(common);
+    node = child;
+  }
+
+  return node;
+}
+
+bool Router::match_node(const Node &node, std::string_view path,
+                        RouteMatch &match) const {
+  if (path.empty() && node.route != std::string::npos) {
+    match.route = node.route;
+    return true;
+  }
+
+  if (!path.empty()) {
+    size_t index = node.indices.find(path.front());
+
+    if (index != std::string::npos) {
+      const Node &child = *node.children[index];
+
+      if (path.substr(0, child.prefix.size()) == child.prefix &&
+          this->match_node(child, path.substr(child.prefix.size()), match))
+        return true;
+    }
+  }
+
+  if (node.param && match.param_count < WEBLET_MAX_ROUTE_PARAMS) {
+    size_t end = 0, slot = match.param_count++;
+    while (end < path.size() && path[end] != '/' &&
+           path[end] != node.param->delimiter)
+      end++;
+
+    match.params[slot] = path.substr(0, end);
+    if (this->match_node(*node.param, path.substr(end), match))
+      return true;
+
+    match.param_count = slot;
+  }
+
+  if (node.wildcard && node.wildcard->route != std::string::npos &&
+      match.param_count < WEBLET_MAX_ROUTE_PARAMS) {
+    match.params[match.param_count++] = path;
+    match.route = node.wildcard->route;
+
+    return true;
+  }
+
+  return false;
+}
+
+} // namespace Purple::Net
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/event_loop.hpp>
+#include <purple/net/sse.hpp>
+
+namespace Purple::Net {
+
+std::string encode_sse_event(uint64_t id, std::string_view event,
+                             std::string_view data) {
+  std::string encoded;
+  encoded.reserve(data.size() + event.size() + 48);
+  encoded.append("id: ").append(std::to_string(id)).append("\n");
+
+  if (!event.empty()) {
+    encoded.append("event: ");
+
+    for (char c : event)
+      if (c != '\r' && c != '\n')
+        encoded.push_back(c);
+
+    encoded.push_back('\n');
+  }
+
+  size_t start = 0;
+  while (true) {
+    size_t end = data.find_first_of("\r\n", start);
+    encoded.append("data: ")
+        .append(data.substr(start, end == std::string_view::npos
+                                       ? std::string_view::npos
+                                       : end - start))
+        .append("\n");
+
+    if (end == std::string_view::npos)
+      break;
+
+    start = end + 1;
+    if (data[end] == '\r' && start < data.size() && data[start] == '\n')
+      start++;
+  }
+
+  return encoded.append("\n");
+}
+
+SsePublisher::SsePublisher(size_t history, size_t max_backlog,
+                           SseOverflow policy)
+    : mutex(), last_id(0), history(), subscribers(), history_size(history),
+      backlog_limit(max_backlog), overflow(policy) {}
+
+void SsePublisher::deliver(std::shared_ptr<const std::string> event) {
+  auto member = this->subscribers.begin();
+
+  while (member != this->subscribers.end()) {
+    EventLoop *loop = member->first.first;
+    FrameDelivery delivery{event, {}, false};
+
+    for (; member != this->subscribers.end() && member->first.first == loop;
+         member++)
+      delivery.targets.push_back({member->second, member->first.second});
+
+    loop->post_frames(std::move(delivery));
+  }
+}
+
+uint64_t SsePublisher::publish(std::string_view data, std::string_view event) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  uint64_t id = ++this->last_id;
+  std::shared_ptr<const std::string> encoded =
+      std::make_shared<const std::string>(encode_sse_event(id, event, data));
+
+  if (this->history_size != 0) {
+    if (this->history.size() == this->history_size)
+      this->history.pop_front();
+
+    this->history.push_back({id, encoded});
+  }
+
+  this->deliver(std::move(encoded));
+  return id;
+}
+
+void SsePublisher::heartbeat() {
+  static const std::shared_ptr<const std::string> comment =
+      std::make_shared<const std::string>(":\n\n");
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->deliver(comment);
+}
+
+size_t SsePublisher::size() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->subscribers.size();
+}
+
+size_t SsePublisher::max_backlog() const { return this->backlog_limit; }
+
+SseOverflow SsePublisher::overflow_policy() const { return this->overflow; }
+
+std::vector<std::shared_ptr<const std::string>>
+SsePublisher::subscribe(EventLoop *loop, uint64_t identifier, int descriptor,
+                        uint64_t last_event_id) {
+  std::vector<std::shared_ptr<const std::string>> missed;
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  this->subscribers[{loop, identifier}] = descriptor;
+  if (last_event_id == 0)
+    return missed;
+
+  for (const auto &[id, event] : this->history)
+    if (id > last_event_id)
+      missed.push_back(event);
+
+  return missed;
+}
+
+void SsePublisher::unsubscribe(EventLoop *loop, uint64_t identifier) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->subscribers.erase({loop, identifier});
+}
+
+} // namespace Purple::Net
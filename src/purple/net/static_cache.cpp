@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/compression.hpp>
+#include <purple/net/mime.hpp>
+#include <purple/net/static_cache.hpp>
+#include <purple/net/weblet.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Purple::Net {
+
+static bool read_file(int file_desc, size_t size, std::string &buffer) {
+  buffer.resize(size);
+
+  for (size_t offset = 0; offset < size;) {
+    ssize_t bytes_read =
+        pread(file_desc, buffer.data() + offset, size - offset, offset);
+
+    if (bytes_read > 0)
+      offset += bytes_read;
+    else if (bytes_read == -1 && errno == EINTR)
+      continue;
+    else
+      return false;
+  }
+
+  return true;
+}
+
+StaticCache::StaticCache(const std::string &root_dir)
+    : root(root_dir), inotify_desc(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+      memory_max_size(WEBLET_SENDFILE_THRESHOLD), compression_min_size(0),
+      compression_enabled(false), mutex(), entries(), watches(),
+      generation(0) {}
+
+StaticCache::~StaticCache() {
+  if (this->inotify_desc != -1)
+    close(this->inotify_desc);
+}
+
+std::shared_ptr<const StaticAsset> StaticCache::find(const std::string &path) {
+  if (this->inotify_desc == -1)
+    return this->load(path);
+
+  uint64_t loaded_generation;
+  {
+    std::shared_lock<std::shared_mutex> lock(this->mutex);
+    auto found = this->entries.find(path);
+
+    if (found != this->entries.end())
+      return found->second;
+    loaded_generation = this->generation;
+  }
+
+  size_t last_slash = path.rfind('/');
+  this->watch_directory(
+      path.substr(0, last_slash == std::string::npos ? 0 : last_slash));
+
+  std::shared_ptr<const StaticAsset> asset = this->load(path);
+  if (!asset)
+    return nullptr;
+
+  std::unique_lock<std::shared_mutex> lock(this->mutex);
+  if (this->generation != loaded_generation)
+    return asset;
+  else if (this->entries.size() >= WEBLET_STATIC_CACHE_MAX_ENTRIES)
+    this->entries.erase(this->entries.begin());
+
+  this->entries[path] = asset;
+  return asset;
+}
+
+void StaticCache::set_memory_limit(size_t max_size) {
+  this->memory_max_size = max_size;
+}
+
+void StaticCache::enable_compression(size_t min_size) {
+  this->compression_min_size = min_size;
+  this->compression_enabled = true;
+}
+
+int StaticCache::watch_desc() const { return this->inotify_desc; }
+
+void StaticCache::process_events() {
+  alignas(struct inotify_event) char buffer[4096];
+  ssize_t length;
+
+  while ((length = read(this->inotify_desc, buffer, sizeof(buffer))) > 0) {
+    std::unique_lock<std::shared_mutex> lock(this->mutex);
+    this->generation++;
+
+    for (char *ptr = buffer; ptr < buffer + length;) {
+      const struct inotify_event *event =
+          reinterpret_cast<const struct inotify_event *>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        this->entries.clear();
+        continue;
+      }
+
+      auto watch = this->watches.find(event->wd);
+      if (watch == this->watches.end())
+        continue;
+
+      std::string directory = watch->second;
+      if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+        this->invalidate_prefix(directory + "/");
+
+        if (event->mask & IN_IGNORED)
+          this->watches.erase(watch);
+      } else if (event->len > 0) {
+        std::string key = directory + "/" + event->name;
+        this->entries.erase(key);
+
+        if (key.size() > 3 && key.compare(key.size() - 3, 3, ".gz") == 0)
+          this->entries.erase(key.substr(0, key.size() - 3));
+
+        if (event->mask & IN_ISDIR)
+          this->invalidate_prefix(key + "/");
+      }
+    }
+  }
+}
+
+std::shared_ptr<const StaticAsset>
+StaticCache::load(const std::string &path) {
+  int file_desc = open((this->root + path).c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat file_stat;
+
+  if (file_desc == -1)
+    return nullptr;
+  else if (fstat(file_desc, &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+    close(file_desc);
+    return nullptr;
+  }
+
+  std::shared_ptr<StaticAsset> asset = std::make_shared<StaticAsset>();
+  asset->size = static_cast<size_t>(file_stat.st_size);
+  asset->modified_time = file_stat.st_mtim.tv_sec;
+  asset->content_type = get_mime_type(path);
+  asset->last_modified = format_http_date(asset->modified_time);
+  asset->file = std::make_shared<ResponseFile>(file_desc, 0, asset->size);
+
+  char etag[64];
+  snprintf(etag, sizeof(etag), "\"%llx-%llx-%llx\"",
+           static_cast<unsigned long long>(file_stat.st_ino),
+           static_cast<unsigned long long>(file_stat.st_size),
+           static_cast<unsigned long long>(file_stat.st_mtim.tv_sec) *
+                   1000000000ULL +
+               file_stat.st_mtim.tv_nsec);
+  asset->etag = etag;
+
+  if (asset->size > 0 && asset->size <= this->memory_max_size) {
+    if (!read_file(file_desc, asset->size, asset->encoded))
+      return nullptr;
+    asset->contents = asset->encoded.data();
+  }
+
+  if (this->compression_enabled &&
+      (path.size() < 3 || path.compare(path.size() - 3, 3, ".gz") != 0))
+    asset->gzip = this->load_gzip(path, *asset);
+
+  return asset;
+}
+
+std::shared_ptr<const StaticAsset>
+StaticCache::load_gzip(const std::string &path, const StaticAsset &asset) {
+  std::shared_ptr<const StaticAsset> sibling = this->load(path + ".gz");
+  if (sibling && sibling->modified_time >= asset.modified_time)
+    return sibling;
+  else if (this->inotify_desc == -1 || asset.size == 0 ||
+           asset.size < this->compression_min_size ||
+           asset.size > WEBLET_COMPRESSION_MAX_STATIC ||
+           !is_compressible_type(asset.content_type))
+    return nullptr;
+
+  std::string buffer;
+  std::string_view contents(asset.contents, asset.size);
+
+  if (!asset.contents) {
+    if (!read_file(asset.file->fd, asset.size, buffer))
+      return nullptr;
+    contents = buffer;
+  }
+
+  std::shared_ptr<StaticAsset> variant = std::make_shared<StaticAsset>();
+  if (!compress_body(ContentCoding::Gzip, contents, Z_BEST_COMPRESSION,
+                     variant->encoded))
+    return nullptr;
+
+  variant->content_type = asset.content_type;
+  variant->etag = asset.etag.substr(0, asset.etag.size() - 1) + "-gz\"";
+  variant->last_modified = asset.last_modified;
+  variant->modified_time = asset.modified_time;
+  variant->size = variant->encoded.size();
+  variant->contents = variant->encoded.data();
+
+  return variant;
+}
+
+void StaticCache::watch_directory(const std::string &directory) {
+  int watch = inotify_add_watch(this->inotify_desc,
+                                (this->root + directory).c_str(),
+                                IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                    IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                    IN_MOVED_TO | IN_DELETE_SELF |
+                                    IN_MOVE_SELF);
+
+  if (watch == -1)
+    return;
+
+  std::unique_lock<std::shared_mutex> lock(this->mutex);
+  this->watches[watch] = directory;
+}
+
+void StaticCache::invalidate_prefix(const std::string &prefix) {
+  for (auto entry = this->entries.begin(); entry != this->entries.end();)
+    if (entry->first.compare(0, prefix.size(), prefix) == 0)
+      entry = this->entries.erase(entry);
+    else
+      entry++;
+}
+
+std::string format_http_date(std::time_t time) {
+  struct tm time_parts;
+  char buffer[64];
+
+  gmtime_r(&time, &time_parts);
+  strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &time_parts);
+
+  return buffer;
+}
+
+bool parse_http_date(std::string_view date, std::time_t &time) {
+  char terminated[64];
+  if (date.size() >= sizeof(terminated))
+    return false;
+
+  date.copy(terminated, date.size());
+  terminated[date.size()] = '\0';
+
+  struct tm time_parts = {};
+  const char *end =
+      strptime(terminated, "%a, %d %b %Y %H:%M:%S GMT", &time_parts);
+
+  if (!end)
+    return false;
+
+  time = timegm(&time_parts);
+  return true;
+}
+
+} // namespace Purple::Net
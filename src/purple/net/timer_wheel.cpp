@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/timer_wheel.hpp>
+
+#include <algorithm>
+
+namespace Purple::Net {
+
+void TimerWheel::schedule(const TimerEntry &entry) {
+  this->place(entry);
+  this->timer_count++;
+}
+
+void TimerWheel::advance(long long now, std::vector<TimerEntry> &expired) {
+  long long target = now / this->tick_ms;
+
+  if (this->timer_count == 0) {
+    this->current = std::max(this->current, target);
+    return;
+  }
+
+  std::vector<TimerEntry> due;
+  while (this->current < target) {
+    this->current++;
+
+    for (size_t level = 1; level < WEBLET_TIMER_WHEEL_LEVELS; level++) {
+      if (this->current & ((1ll << (WEBLET_TIMER_WHEEL_BITS * level)) - 1))
+        break;
+
+      this->cascade(level);
+    }
+
+    due.swap(this->slots[this->current & slot_mask]);
+    for (const TimerEntry &entry : due) {
+      if ((entry.deadline + this->tick_ms - 1) / this->tick_ms >
+          this->current) {
+        this->place(entry);
+        continue;
+      }
+
+      expired.push_back(entry);
+      this->timer_count--;
+    }
+
+    due.clear();
+  }
+}
+
+size_t TimerWheel::size() const { return this->timer_count; }
+
+void TimerWheel::place(const TimerEntry &entry) {
+  long long tick = (entry.deadline + this->tick_ms - 1) / this->tick_ms;
+  long long span = 1ll << (WEBLET_TIMER_WHEEL_BITS * WEBLET_TIMER_WHEEL_LEVELS);
+
+  tick = std::clamp(tick, this->current + 1, this->current + span - 1);
+
+  long long delta = tick - this->current;
+  size_t level = 0;
+
+  while (level + 1 < WEBLET_TIMER_WHEEL_LEVELS &&
+         delta >= (1ll << (WEBLET_TIMER_WHEEL_BITS * (level + 1))))
+    level++;
+
+  size_t index = (tick >> (WEBLET_TIMER_WHEEL_BITS * level)) & slot_mask;
+  this->slots[level * slot_count + index].push_back(entry);
+}
+
+void TimerWheel::cascade(size_t level) {
+  size_t index =
+      (this->current >> (WEBLET_TIMER_WHEEL_BITS * level)) & slot_mask;
+  std::vector<TimerEntry> moving;
+
+  moving.swap(this->slots[level * slot_count + index]);
+  for (const TimerEntry &entry : moving)
+    this->place(entry);
+}
+
+} // namespace Purple::Net
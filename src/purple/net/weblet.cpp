@@ -20,19 +20,226 @@
 #include <purple/net/mime.hpp>
 #include <purple/net/weblet.hpp>
 
+#include <algorithm>
 #include <cerrno>
+#include <charconv>
+#include <cstdlib>
 #include <cstring>
-#include <filesystem>
 #include <fstream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <tuple>
 
 #include <arpa/inet.h>
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 namespace Purple::Net {
 
+enum RingOp : uint64_t {
+  RingAccept = 1,
+  RingRead,
+  RingReadable,
+  RingSend,
+  RingWritable,
+  RingWake,
+  RingWatch,
+  RingTick
+};
+
+static inline uint64_t ring_data(RingOp op, int fd) {
+  return (static_cast<uint64_t>(op) << 32) | static_cast<uint32_t>(fd);
+}
+
+static const char *status_text(int status_code) {
+  switch (status_code) {
+  case 400:
+    return "Bad Request";
+  case 405:
+    return "Method Not Allowed";
+  case 408:
+    return "Request Timeout";
+  case 413:
+    return "Payload Too Large";
+  case 426:
+    return "Upgrade Required";
+  case 429:
+    return "Too Many Requests";
+  case 500:
+    return "Internal Server Error";
+  case 501:
+    return "Not Implemented";
+  case 503:
+    return "Service Unavailable";
+  default:
+    return "Not Found";
+  }
+}
+
+static bool has_token(std::string_view header, std::string_view token) {
+  while (!header.empty()) {
+    size_t separator = header.find(',');
+    std::string_view item = header.substr(0, separator);
+
+    header = separator == std::string_view::npos ? std::string_view()
+                                                 : header.substr(separator + 1);
+
+    while (!item.empty() && item.front() == ' ')
+      item.remove_prefix(1);
+    while (!item.empty() && item.back() == ' ')
+      item.remove_suffix(1);
+
+    if (iequals(item, token))
+      return true;
+  }
+
+  return false;
+}
+
+enum RangeParse { RangeInvalid, RangeUnsatisfiable, RangeSatisfiable };
+
+static RangeParse parse_byte_ranges(
+    std::string_view header, size_t size,
+    std::vector<std::pair<size_t, size_t>> &ranges) {
+  if (header.size() < 6 || !iequals(header.substr(0, 6), "bytes="))
+    return RangeInvalid;
+
+  bool specified = false;
+  header.remove_prefix(6);
+
+  while (!header.empty()) {
+    size_t separator = header.find(',');
+    std::string_view item = header.substr(0, separator);
+
+    header = separator == std::string_view::npos ? std::string_view()
+                                                 : header.substr(separator + 1);
+
+    while (!item.empty() && item.front() == ' ')
+      item.remove_prefix(1);
+    while (!item.empty() && item.back() == ' ')
+      item.remove_suffix(1);
+
+    size_t dash = item.find('-');
+    if (item.empty())
+      continue;
+    else if (dash == std::string_view::npos)
+      return RangeInvalid;
+
+    std::string_view first_text = item.substr(0, dash),
+                     last_text = item.substr(dash + 1);
+    size_t first = 0, last = 0;
+
+    if ((!first_text.empty() &&
+         std::from_chars(first_text.data(),
+                         first_text.data() + first_text.size(), first)
+                 .ptr != first_text.data() + first_text.size()) ||
+        (!last_text.empty() &&
+         std::from_chars(last_text.data(), last_text.data() + last_text.size(),
+                         last)
+                 .ptr != last_text.data() + last_text.size()) ||
+        (first_text.empty() && last_text.empty()))
+      return RangeInvalid;
+
+    specified = true;
+    if (first_text.empty()) {
+      if (last == 0 || size == 0)
+        continue;
+
+      first = last < size ? size - last : 0;
+      last = size - 1;
+    } else if (!last_text.empty() && last < first)
+      return RangeInvalid;
+    else if (first >= size)
+      continue;
+    else if (last_text.empty() || last >= size)
+      last = size - 1;
+
+    ranges.push_back({first, last});
+    if (ranges.size() > WEBLET_MAX_BYTE_RANGES)
+      return RangeInvalid;
+  }
+
+  if (!specified)
+    return RangeInvalid;
+
+  return ranges.empty() ? RangeUnsatisfiable : RangeSatisfiable;
+}
+
+RateLimitKey rate_limit_by_header(const std::string &name) {
+  return [name](const Request &request) {
+    auto header = request.headers.find(name);
+    return header != request.headers.end() ? std::string(header->second)
+                                           : std::string();
+  };
+}
+
+RateLimitKey rate_limit_by_cookie(const std::string &name) {
+  return [name](const Request &request) {
+    auto cookie = request.cookies.find(name);
+    return cookie != request.cookies.end() ? cookie->second : std::string();
+  };
+}
+
+Middleware cors_middleware(const std::string &origin,
+                           const std::string &methods,
+                           const std::string &headers, int max_age) {
+  auto allowed = [origin](const Request &request) {
+    if (origin == "*")
+      return true;
+
+    auto header = request.headers.find("Origin");
+    return header != request.headers.end() &&
+           std::string_view(header->second) == origin;
+  };
+
+  return Middleware(
+      [origin, methods, headers, max_age,
+       allowed](const RequestContext &context, Response &response) {
+        const Request &request = context.request;
+        if (request.method != "OPTIONS" ||
+            !request.headers.count("Access-Control-Request-Method"))
+          return true;
+
+        response.status_code = 204;
+        response.status_message = "No Content";
+
+        if (allowed(request)) {
+          response.set_header("Access-Control-Allow-Methods", methods);
+          response.set_header("Access-Control-Allow-Headers", headers);
+          response.set_header("Access-Control-Max-Age",
+                              std::to_string(max_age));
+        }
+        return false;
+      },
+      [origin, allowed](const RequestContext &context, Response &response) {
+        if (!allowed(context.request))
+          return;
+
+        response.set_header("Access-Control-Allow-Origin", origin);
+        if (origin == "*")
+          return;
+
+        auto vary = response.headers.find("Vary");
+        if (vary == response.headers.end())
+          response.set_header("Vary", "Origin");
+        else if (vary->second != "*" && !has_token(vary->second, "Origin"))
+          vary->second.append(", Origin");
+      });
+}
+
 void Response::set_header(const std::string &key, const std::string &value) {
   this->headers[key] = value;
 }
@@ -51,6 +258,45 @@ void Response::set_cookie(
   this->cookies[name] = cookieString;
 }
 
+ResponseFile::~ResponseFile() {
+  if (this->fd != -1 && !this->source)
+    close(this->fd);
+}
+
+size_t ResponseFile::body_length() const {
+  size_t total = 0;
+
+  for (const ResponseFile *region = this; region;
+       region = region->next.get())
+    total += region->prefix.size() + region->length;
+
+  return total;
+}
+
+std::string_view RouteParams::get(std::string_view name) const {
+  for (size_t i = 0; i < this->size(); i++)
+    if (this->names[i] == name)
+      return this->match.params[i];
+
+  return std::string_view();
+}
+
+bool RouteParams::has(std::string_view name) const {
+  return !this->get(name).empty();
+}
+
+size_t RouteParams::size() const {
+  return std::min(this->names.size(), this->match.param_count);
+}
+
+const std::string &RouteParams::name(size_t index) const {
+  return this->names[index];
+}
+
+std::string_view RouteParams::value(size_t index) const {
+  return this->match.params[index];
+}
+
 SocketCloser::~SocketCloser() {
   if (this->fd != -1)
     close(this->fd);
@@ -66,29 +312,100 @@ Weblet::~Weblet() {
       dlclose(handle);
 }
 
-void Weblet::handle(const std::string &path_pattern, RequestHandler handler) {
-  std::string regexPattern = path_pattern;
+void Weblet::handle(const std::string &path_pattern, ContextHandler handler) {
+  std::vector<std::string> path_names;
+
+  if (!this->router.insert(path_pattern, this->routes.size(), path_names)) {
+    this->handler_exception("Invalid or duplicate route pattern: " +
+                            path_pattern);
+    return;
+  }
+
+  this->routes.push_back({path_pattern, path_names, std::move(handler), nullptr,
+                          nullptr, nullptr, nullptr, nullptr});
+}
+
+void Weblet::handle(const std::string &path_pattern, AsyncHandler handler) {
+  std::vector<std::string> path_names;
+
+  if (!this->router.insert(path_pattern, this->routes.size(), path_names)) {
+    this->handler_exception("Invalid or duplicate route pattern: " +
+                            path_pattern);
+    return;
+  }
+
+  this->routes.push_back({path_pattern, path_names, nullptr, std::move(handler),
+                          nullptr, nullptr, nullptr, nullptr});
+  this->async_routes = true;
+}
+
+void Weblet::handle_websocket(const std::string &path_pattern,
+                              WebSocketHandler handler) {
   std::vector<std::string> path_names;
 
-  std::regex paramRegex(R"(\{([a-zA-Z0-9_]+)\})");
-  std::sregex_iterator it(path_pattern.begin(), path_pattern.end(), paramRegex);
+  if (!this->router.insert(path_pattern, this->routes.size(), path_names)) {
+    this->handler_exception("Invalid or duplicate route pattern: " +
+                            path_pattern);
+    return;
+  }
+
+  this->routes.push_back(
+      {path_pattern, path_names, nullptr, nullptr, nullptr,
+       std::make_shared<const WebSocketHandler>(std::move(handler)), nullptr,
+       nullptr});
+  this->websocket_routes = true;
+}
 
-  std::sregex_iterator end;
-  while (it != end) {
-    std::smatch match = *it;
-    path_names.push_back(match[1].str());
+void Weblet::handle_sse(const std::string &path_pattern,
+                        std::shared_ptr<SsePublisher> publisher) {
+  std::vector<std::string> path_names;
 
-    regexPattern = std::regex_replace(regexPattern, paramRegex, "([^/]*)",
-                                      std::regex_constants::format_first_only);
-    it++;
+  if (!this->router.insert(path_pattern, this->routes.size(), path_names)) {
+    this->handler_exception("Invalid or duplicate route pattern: " +
+                            path_pattern);
+    return;
   }
 
-  regexPattern = "^" + regexPattern + "$";
-  this->routes.push_back({std::regex(regexPattern), path_names, handler});
+  this->routes.push_back({path_pattern, path_names, nullptr, nullptr, nullptr,
+                          nullptr, std::move(publisher), nullptr});
+  this->sse_routes = true;
+}
+
+void Weblet::handle(const std::string &path_pattern, ContextHandler handler,
+                    CachePolicy policy) {
+  size_t route_count = this->routes.size();
+  this->handle(path_pattern, std::move(handler));
+
+  if (this->routes.size() > route_count)
+    this->routes.back().cache =
+        std::make_shared<const CachePolicy>(std::move(policy));
+}
+
+void Weblet::handle(const std::string &path_pattern, RequestHandler handler) {
+  this->handle(path_pattern, [handler = std::move(handler)](
+                                 const RequestContext &context) {
+    std::map<std::string, std::string> parameters;
+
+    for (size_t i = 0; i < context.params.size(); i++)
+      if (!context.params.value(i).empty())
+        parameters[context.params.name(i)] =
+            std::string(context.params.value(i));
+
+    return handler(context.config, context.request, parameters);
+  });
 }
 
 void Weblet::handle_public(const std::string &public_dir) {
   this->public_dir = public_dir;
+  this->static_cache = std::make_unique<StaticCache>(public_dir);
+}
+
+void Weblet::use(Middleware middleware) {
+  this->global_middleware.push_back(std::move(middleware));
+}
+
+void Weblet::use(const std::string &path_pattern, Middleware middleware) {
+  this->route_middleware.push_back({path_pattern, std::move(middleware)});
 }
 
 void Weblet::add_error_handler(int error_code, const std::string &filepath) {
@@ -152,520 +469,2628 @@ RequestHandler Weblet::load_response(int shared_mods,
   return RequestHandler(func_ptr);
 }
 
-void Weblet::start() {
-  Purple::Concurrent::go<std::function<void()>>(&this->tasklet_manager, [this] {
-    server_desc = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_desc == -1)
-      throw WebletException("Socket failed");
-
-    int opt = 1;
-    if (setsockopt(this->server_desc, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT,
-                   &opt, sizeof(opt))) {
-      close(this->server_desc);
-      throw WebletException("Socket control behavior error");
-    }
-
-    sockaddr_in address;
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr =
-        (this->hostname == "localhost" || this->hostname == "127.0.0.1")
-            ? INADDR_ANY
-            : inet_addr(this->hostname.c_str());
-    address.sin_port = htons(this->port);
+ContextHandler Weblet::load_context_response(int shared_mods,
+                                             std::string response_name) {
+  auto failure = [](const std::string &message) {
+    return [message](const RequestContext &) -> Response {
+      Response res;
+      res.status_code = 500;
+      res.status_message = "Internal Server Error";
+      res.contents = message;
 
-    if (bind(this->server_desc, (struct sockaddr *)&address, sizeof(address)) <
-        0) {
-      close(this->server_desc);
-      throw WebletException("Socket binding failed");
-    }
+      return res;
+    };
+  };
 
-    if (listen(this->server_desc, 10) < 0) {
-      close(this->server_desc);
-      throw WebletException("Socket listening failed");
-    }
+  if (this->loaded_mods.find(shared_mods) == this->loaded_mods.end() ||
+      !this->loaded_mods[shared_mods]) {
+    this->handler_exception("Shared module with ID " +
+                            std::to_string(shared_mods) +
+                            " not found or invalid");
 
-    while (true) {
-      sockaddr_in client_address;
-      socklen_t client_addr_len = sizeof(client_address);
+    return failure("Error: Dynamic module not loaded.");
+  }
 
-      int accepted_fd = accept(server_desc, (struct sockaddr *)&client_address,
-                               &client_addr_len);
+  void *handle = this->loaded_mods[shared_mods];
+  typedef Response (*DynamicHandlerPtr)(const RequestContext &);
 
-      if (accepted_fd < 0) {
-        if (errno == EBADF || errno == EINVAL)
-          break;
+  DynamicHandlerPtr func_ptr =
+      (DynamicHandlerPtr)dlsym(handle, response_name.c_str());
 
-        this->handler_exception("Failed to accept socket: " +
-                                std::string(strerror(errno)));
-        continue;
-      }
+  if (!func_ptr) {
+    this->handler_exception("Error finding function '" + response_name +
+                            "' in module ID " + std::to_string(shared_mods) +
+                            ": " + std::string(dlerror()));
 
-      SocketCloser client_socket(accepted_fd);
-      this->handle_client(static_cast<int>(client_socket));
-    }
+    return failure("Error: Dynamic handler function not found.");
+  }
 
-    if (this->server_desc != -1) {
-      close(this->server_desc);
-      this->server_desc = -1;
-    }
-  });
+  return ContextHandler(func_ptr);
 }
 
-void Weblet::stop() {
-  if (this->server_desc != -1) {
-    shutdown(this->server_desc, SHUT_RDWR);
-    close(this->server_desc);
+void Weblet::start() {
+  if (this->running)
+    return;
 
-    this->server_desc = -1;
-  }
+  size_t shard_count = this->event_loop_count;
+  if (shard_count == 0)
+    shard_count = std::max(1u, std::thread::hardware_concurrency());
 
-  this->tasklet_manager.wait_for_completion();
-}
+  std::vector<std::unique_ptr<EventLoop>> loops;
+  int watch_desc = this->static_cache ? this->static_cache->watch_desc() : -1;
 
-bool Weblet::is_running() { return this->server_desc != -1; }
+  if (!this->response_cache &&
+      std::any_of(this->routes.begin(), this->routes.end(),
+                  [](const Route &route) { return route.cache != nullptr; }))
+    this->response_cache = std::make_unique<ResponseCache>(
+        this->response_cache_size, this->response_cache_items);
 
-ssize_t Weblet::safe_send(int sock_desc, const std::string &data, int flags) {
-  size_t total_sent = 0;
-  size_t len = data.length();
+  Response overload = this->handle_error(503, "Server is overloaded.");
+  overload.set_header("Retry-After", std::to_string(this->retry_after));
+  overload.set_header("Connection", "close");
+  this->overload_response =
+      this->build_response_head(overload) + overload.contents;
 
-  while (total_sent < len) {
-    ssize_t bytes_sent =
-        send(sock_desc, data.c_str() + total_sent, len - total_sent, flags);
+  if (this->static_cache)
+    this->static_cache->set_memory_limit(this->sendfile_threshold);
+  if (this->static_cache && this->compression_enabled)
+    this->static_cache->enable_compression(this->compression_min_size);
 
-    if (bytes_sent <= 0) {
-      if (bytes_sent == 0)
-        this->handler_exception("Peer closed connection unexpectedly");
-      else
-        this->handler_exception("Connection failed safe send function failed");
+  this->build_middleware();
+  this->scheduler.start();
 
-      return -1;
-    }
+  if (this->metrics_enabled && !this->metrics) {
+    std::vector<std::string> labels;
+    for (const Route &route : this->routes)
+      labels.push_back(route.pattern);
 
-    total_sent += bytes_sent;
+    labels.push_back("");
+    this->metrics = std::make_unique<WebletMetrics>(std::move(labels));
   }
 
-  return total_sent;
-}
+  for (size_t shard = 0; shard < shard_count; shard++) {
+    std::unique_ptr<EventLoop> loop = std::make_unique<EventLoop>();
+    loop->listen_desc = this->open_listener();
+    loop->wake_desc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (loop->wake_desc == -1)
+      throw WebletException("Event loop creation failed");
 
-ssize_t Weblet::safe_recv_to_vec(int sock_desc, std::vector<char> &buffer,
-                                 size_t len_to_read, int flags) {
-  size_t start_pos = buffer.size();
-  buffer.resize(start_pos + len_to_read);
+    if (this->io_uring_enabled && this->setup_io_uring(*loop, shard == 0)) {
+      loops.push_back(std::move(loop));
+      continue;
+    }
 
-  size_t total_received = 0;
-  while (total_received < len_to_read) {
-    ssize_t bytes_received =
-        recv(sock_desc, buffer.data() + start_pos + total_received,
-             len_to_read - total_received, flags);
+    loop->epoll_desc = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_desc == -1)
+      throw WebletException("Event loop creation failed");
 
-    if (bytes_received <= 0) {
-      buffer.resize(start_pos + total_received);
+    for (int desc : {loop->listen_desc, loop->wake_desc,
+                     shard == 0 ? watch_desc : -1}) {
+      if (desc == -1)
+        continue;
 
-      if (bytes_received == 0)
-        this->handler_exception("Peer closed connection");
-      else
-        this->handler_exception("Safe receiving mechanism vector failed");
+      epoll_event event{};
+      event.events = EPOLLIN | EPOLLET;
+      event.data.fd = desc;
 
-      return bytes_received;
+      if (epoll_ctl(loop->epoll_desc, EPOLL_CTL_ADD, desc, &event) == -1)
+        throw WebletException("Event loop registration failed");
     }
 
-    total_received += bytes_received;
+    loops.push_back(std::move(loop));
   }
 
-  buffer.resize(start_pos + total_received);
-  return total_received;
+  this->event_loops = std::move(loops);
+  this->loop_manager = std::make_unique<TaskletManager>(shard_count);
+  this->running = true;
+
+  for (const std::unique_ptr<EventLoop> &loop : this->event_loops)
+    Purple::Concurrent::go<std::function<void()>>(
+        this->loop_manager.get(),
+        [this, target = loop.get()] { this->run_event_loop(*target); });
 }
 
-void Weblet::parse_req_headers(std::istringstream &headers_stream,
-                               Request &request) {
-  std::string line;
-  while (std::getline(headers_stream, line) && line != "\r") {
-    size_t colon_pos = line.find(':');
-    if (colon_pos != std::string::npos) {
-      std::string header_name = line.substr(0, colon_pos);
-      std::string header_value = line.substr(colon_pos + 2);
-
-      if (!header_value.empty() && header_value.back() == '\r')
-        header_value.pop_back();
-
-      request.headers[header_name] = header_value;
-      if (header_name == "Cookie") {
-        std::istringstream cookie_stream(header_value);
-        std::string cookie_pair;
-        while (std::getline(cookie_stream, cookie_pair, ';')) {
-          size_t eq_pos = cookie_pair.find('=');
-
-          if (eq_pos != std::string::npos) {
-            std::string cookie_name = cookie_pair.substr(0, eq_pos);
-            std::string cookie_value = cookie_pair.substr(eq_pos + 1);
-
-            cookie_name.erase(0, cookie_name.find_first_not_of(" \t"));
-            cookie_name.erase(cookie_name.find_last_not_of(" \t") + 1);
-            cookie_value.erase(0, cookie_value.find_first_not_of(" \t"));
-            cookie_value.erase(cookie_value.find_last_not_of(" \t") + 1);
-
-            request.cookies[cookie_name] = cookie_value;
-          }
-        }
-      }
-    }
+void Weblet::stop() {
+  if (this->running.exchange(false)) {
+    for (const std::unique_ptr<EventLoop> &loop : this->event_loops)
+      loop->wake();
+
+    this->loop_manager->wait_for_completion();
+    this->loop_manager.reset();
   }
+
+  this->scheduler.stop();
+  this->tasklet_manager.wait_for_completion();
+  this->event_loops.clear();
 }
 
-void Weblet::parse_url_enc_data(const std::string &body, Request &request) {
-  std::istringstream form_data_stream(body);
-  std::string pair;
+bool Weblet::is_running() { return this->running; }
 
-  auto url_decode =
-      [exception_fn = this->handler_exception](const std::string &encoded_str) {
-        std::string decoded_str;
-        for (size_t i = 0; i < encoded_str.length(); ++i) {
-          if (encoded_str[i] == '+')
-            decoded_str += ' ';
-          else if (encoded_str[i] == '%' && i + 2 < encoded_str.length()) {
-            try {
-              decoded_str += static_cast<char>(
-                  std::stoi(encoded_str.substr(i + 1, 2), nullptr, 16));
-              i += 2;
-            } catch (const std::exception &e) {
-              exception_fn("Malformed URL encoding encountered: " +
-                           encoded_str.substr(i, 3));
-              decoded_str += encoded_str[i];
-            }
-          } else
-            decoded_str += encoded_str[i];
-        }
+int Weblet::open_listener() {
+  int listen_desc =
+      socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
 
-        return decoded_str;
-      };
+  if (listen_desc == -1)
+    throw WebletException("Socket failed");
 
-  while (std::getline(form_data_stream, pair, '&')) {
-    size_t eq_pos = pair.find('=');
-    if (eq_pos != std::string::npos) {
-      std::string key = pair.substr(0, eq_pos);
-      std::string value = pair.substr(eq_pos + 1);
+  int opt = 1;
+  if (setsockopt(listen_desc, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) ||
+      setsockopt(listen_desc, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt))) {
+    close(listen_desc);
+    throw WebletException("Socket control behavior error");
+  }
 
-      request.form_fields[url_decode(key)] = url_decode(value);
-    }
+  sockaddr_in address;
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr =
+      (this->hostname == "localhost" || this->hostname == "127.0.0.1")
+          ? INADDR_ANY
+          : inet_addr(this->hostname.c_str());
+  address.sin_port = htons(this->port);
+
+  if (bind(listen_desc, (struct sockaddr *)&address, sizeof(address)) < 0) {
+    close(listen_desc);
+    throw WebletException("Socket binding failed");
+  }
+
+  if (listen(listen_desc, SOMAXCONN) < 0) {
+    close(listen_desc);
+    throw WebletException("Socket listening failed");
   }
+
+  return listen_desc;
 }
 
-void Weblet::parse_multipart_data(const std::string &body,
-                                  const std::string &boundary,
-                                  Request &request) {
-  std::string delimiter = "--" + boundary;
-  std::string_view body_view(body);
+bool Weblet::setup_io_uring(EventLoop &loop, bool watch) {
+  std::unique_ptr<IoUring> ring = std::make_unique<IoUring>();
+  if (!ring->setup(WEBLET_URING_ENTRIES))
+    return false;
 
-  size_t current_pos = 0;
-  while (true) {
-    size_t part_start_pos = body_view.find(delimiter, current_pos);
+  loop.receive_buffers.resize(WEBLET_URING_BUFFERS * WEBLET_RECV_CHUNK_SIZE);
+  std::vector<iovec> buffers(WEBLET_URING_BUFFERS);
 
-    if (part_start_pos == std::string::npos)
-      break;
+  for (unsigned i = 0; i < WEBLET_URING_BUFFERS; i++) {
+    buffers[i].iov_base = loop.receive_buffers.data() +
+                          static_cast<size_t>(i) * WEBLET_RECV_CHUNK_SIZE;
+    buffers[i].iov_len = WEBLET_RECV_CHUNK_SIZE;
+    loop.free_buffers.push_back(WEBLET_URING_BUFFERS - 1 - i);
+  }
 
-    part_start_pos += delimiter.length();
-    if (body_view.length() >= part_start_pos + 2 &&
-        body_view.substr(part_start_pos, 2) == "--")
-      break;
+  loop.buffers_registered =
+      ring->register_buffers(buffers.data(), WEBLET_URING_BUFFERS);
 
-    if (body_view.length() >= part_start_pos + 2 &&
-        body_view.substr(part_start_pos, 2) == "\r\n")
-      part_start_pos += 2;
-    else {
-      this->handler_exception("Malformed multipart part: boundary not followed "
-                              "by CRLF; will be skipped");
+  ring->prepare_accept_multishot(loop.listen_desc,
+                                 ring_data(RingAccept, loop.listen_desc));
+  ring->prepare_poll(loop.wake_desc, POLLIN,
+                     ring_data(RingWake, loop.wake_desc));
+  ring->prepare_timeout(WEBLET_TIMER_TICK_MS, ring_data(RingTick, -1));
 
-      current_pos = part_start_pos;
-      continue;
-    }
+  if (watch && this->static_cache && this->static_cache->watch_desc() != -1)
+    ring->prepare_poll(
+        this->static_cache->watch_desc(), POLLIN,
+        ring_data(RingWatch, this->static_cache->watch_desc()));
 
-    size_t part_end_pos = body_view.find(delimiter, part_start_pos);
+  loop.ring = std::move(ring);
+  return true;
+}
+
+void Weblet::run_event_loop(EventLoop &loop) {
+  if (loop.ring) {
+    this->run_uring_loop(loop);
+    return;
+  }
+
+  std::vector<epoll_event> events(WEBLET_MAX_EVENTS);
+  loop.timers = TimerWheel(monotonic_ms());
+
+  while (this->running) {
+    int count = epoll_wait(loop.epoll_desc, events.data(),
+                           static_cast<int>(events.size()),
+                           loop.timers.size() ? WEBLET_TIMER_TICK_MS : -1);
+
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
 
-    if (part_end_pos == std::string::npos) {
-      this->handler_exception("Malformed multipart body: part without end "
-                              "delimiter; skipping remaining body");
+      this->handler_exception("Event loop wait failed: " +
+                              std::string(strerror(errno)));
       break;
     }
 
-    std::string_view part_content_view =
-        body_view.substr(part_start_pos, part_end_pos - part_start_pos);
-    size_t headers_end = part_content_view.find("\r\n\r\n");
+    for (int i = 0; i < count; i++) {
+      int fd = events[i].data.fd;
+
+      if (fd == loop.listen_desc)
+        this->accept_clients(loop);
+      else if (fd == loop.wake_desc) {
+        loop.drain_wake();
+        this->deliver_completions(loop);
+        this->deliver_frames(loop);
+      } else if (this->static_cache && fd == this->static_cache->watch_desc())
+        this->static_cache->process_events();
+      else
+        this->service_connection(loop, fd, events[i].events);
+    }
 
-    if (headers_end == std::string::npos) {
-      this->handler_exception(
-          "Malformed multipart part: no header-body separator; skipping part");
+    this->expire_timeouts(loop);
+  }
 
-      current_pos = part_end_pos;
-      continue;
-    }
+  for (const auto &[fd, connection] : loop.connections) {
+    this->release_websocket(*connection);
+    this->release_event_stream(loop, *connection);
+  }
 
-    std::string_view part_headers_view =
-        part_content_view.substr(0, headers_end);
-    std::string_view part_body_view = part_content_view.substr(headers_end + 4);
+  this->open_connections -= loop.connections.size();
+  loop.connections.clear();
+}
 
-    if (part_body_view.length() >= 2 &&
-        part_body_view.substr(part_body_view.length() - 2) == "\r\n")
-      part_body_view = part_body_view.substr(0, part_body_view.length() - 2);
+void Weblet::run_uring_loop(EventLoop &loop) {
+  std::vector<IoUringCompletion> completions;
+  loop.timers = TimerWheel(monotonic_ms());
 
-    std::map<std::string, std::string> part_headers;
-    std::string part_headers_string(part_headers_view);
-    std::istringstream part_headers_stream(part_headers_string);
+  while (this->running) {
+    if (!loop.ring->submit_and_wait(1)) {
+      this->handler_exception("Event loop wait failed: " +
+                              std::string(strerror(errno)));
+      break;
+    }
 
-    std::string header_line;
-    while (std::getline(part_headers_stream, header_line) &&
-           header_line != "\r") {
-      size_t colon_pos = header_line.find(':');
+    completions.clear();
+    loop.ring->reap(completions);
 
-      if (colon_pos != std::string::npos) {
-        std::string header_name = header_line.substr(0, colon_pos);
-        std::string header_value = header_line.substr(colon_pos + 2);
+    for (const IoUringCompletion &completion : completions)
+      this->handle_uring_completion(loop, completion);
+  }
 
-        if (!header_value.empty() && header_value.back() == '\r')
-          header_value.pop_back();
+  std::vector<int> open;
+  for (const auto &[fd, connection] : loop.connections)
+    open.push_back(fd);
 
-        part_headers[header_name] = header_value;
-      }
-    }
+  for (int fd : open)
+    this->close_connection(loop, fd);
 
-    if (part_headers.count("Content-Disposition")) {
-      std::string disposition_str = part_headers["Content-Disposition"];
+  long long deadline = monotonic_ms() + 1000;
+  while (!loop.connections.empty() && monotonic_ms() < deadline &&
+         loop.ring->submit_and_wait(1)) {
+    completions.clear();
+    loop.ring->reap(completions);
 
-      std::smatch match_name;
-      std::regex name_regex("name=\"([^\"]+)\"");
-      std::string field_name_str;
+    for (const IoUringCompletion &completion : completions)
+      this->handle_uring_completion(loop, completion);
+  }
 
-      if (std::regex_search(disposition_str, match_name, name_regex)) {
-        field_name_str = match_name[1].str();
-      } else {
-        this->handler_exception("Multipart part Content-Disposition without "
-                                "'name' attribute; skipping part");
+  this->open_connections -= loop.connections.size();
+  loop.connections.clear();
+}
 
-        current_pos = part_end_pos;
-        continue;
+void Weblet::handle_uring_completion(EventLoop &loop,
+                                     const IoUringCompletion &completion) {
+  RingOp op = static_cast<RingOp>(completion.user_data >> 32);
+  int fd = static_cast<int>(completion.user_data & 0xffffffff);
+
+  if (op == RingAccept) {
+    if (completion.result >= 0) {
+      long long accept_started = this->metrics ? monotonic_ns() : 0;
+      this->add_connection(loop, completion.result,
+                           loop.multishot_accept ? nullptr
+                                                 : &loop.accept_address);
+
+      if (this->metrics)
+        this->metrics->record(this->routes.size(), RequestPhase::Accept,
+                              monotonic_ns() - accept_started);
+    } else if (completion.result == -EINVAL && loop.multishot_accept)
+      loop.multishot_accept = false;
+    else if (completion.result != -EINTR && completion.result != -EAGAIN &&
+             completion.result != -ECONNABORTED)
+      this->handler_exception("Failed to accept socket: " +
+                              std::string(strerror(-completion.result)));
+
+    if (!completion.more && this->running) {
+      if (loop.multishot_accept)
+        loop.ring->prepare_accept_multishot(fd, completion.user_data);
+      else {
+        loop.accept_address_length = sizeof(loop.accept_address);
+        loop.ring->prepare_accept(
+            fd, reinterpret_cast<sockaddr *>(&loop.accept_address),
+            &loop.accept_address_length, completion.user_data);
       }
+    }
 
-      std::smatch match_filename;
-      std::regex filename_regex("filename=\"([^\"]+)\"");
+    return;
+  } else if (op == RingWake) {
+    loop.drain_wake();
+    this->deliver_completions(loop);
+    this->deliver_frames(loop);
+    loop.ring->prepare_poll(fd, POLLIN, completion.user_data);
 
-      if (std::regex_search(disposition_str, match_filename, filename_regex)) {
-        UploadedFile file;
-        file.filename = match_filename[1].str();
-        file.content_type = part_headers.count("Content-Type")
-                                ? part_headers["Content-Type"]
-                                : "application/octet-stream";
-        file.data.assign(part_body_view.begin(), part_body_view.end());
+    return;
+  } else if (op == RingWatch) {
+    this->static_cache->process_events();
+    loop.ring->prepare_poll(fd, POLLIN, completion.user_data);
 
-        request.upload_files[field_name_str] = file;
-      } else
-        request.form_fields[field_name_str] = std::string(part_body_view);
-    } else
-      this->handler_exception(
-          "Multipart part without Content-Disposition header; skipping part");
+    return;
+  } else if (op == RingTick) {
+    this->expire_timeouts(loop);
+    loop.ring->prepare_timeout(WEBLET_TIMER_TICK_MS, completion.user_data);
 
-    current_pos = part_end_pos;
+    return;
   }
-}
 
-std::string Weblet::build_response_str(const Response &response) {
-  std::ostringstream response_stream;
+  auto found = loop.connections.find(fd);
+  if (found == loop.connections.end())
+    return;
 
-  response_stream << "HTTP/1.1 " << response.status_code << " "
-                  << response.status_message << "\r\n";
-  response_stream << "Content-Length: " << response.contents.length() << "\r\n";
+  Connection &connection = *found->second;
+  connection.ops_in_flight--;
 
-  for (const auto &header : response.headers)
-    response_stream << header.first << ": " << header.second << "\r\n";
+  if (op == RingRead || op == RingReadable)
+    connection.receiving = false;
+  else
+    connection.sending = false;
 
-  for (const auto &cookie : response.cookies)
-    response_stream << "Set-Cookie: " << cookie.second << "\r\n";
+  if (op == RingRead && completion.result > 0)
+    connection.input.append(loop.receive_buffers.data() +
+                                static_cast<size_t>(connection.receive_buffer) *
+                                    WEBLET_RECV_CHUNK_SIZE,
+                            completion.result);
 
-  response_stream << "\r\n";
-  response_stream << response.contents;
+  if (op == RingRead)
+    this->release_buffer(loop, connection);
 
-  return response_stream.str();
-}
+  if (connection.closing) {
+    if (connection.ops_in_flight == 0) {
+      loop.connections.erase(found);
+      this->open_connections--;
+    }
+
+    return;
+  }
 
-void Weblet::handle_client(int client_socket_fd) {
-  std::vector<char> raw_request_bytes;
-  raw_request_bytes.reserve(4096);
+  bool alive = true;
+  if (op == RingReadable)
+    this->start_read(loop, connection);
+  else if (op == RingRead) {
+    if (completion.result == -EAGAIN || completion.result == -EINTR)
+      this->arm_receive(loop, connection);
+    else if (completion.result < 0)
+      alive = false;
+    else {
+      alive = this->receive_input(loop, connection, completion.result == 0);
+      if (alive && completion.result > 0) {
+        if (this->input_full(connection))
+          connection.read_paused = true;
+        else if (completion.result == WEBLET_RECV_CHUNK_SIZE)
+          this->start_read(loop, connection);
+        else
+          this->arm_receive(loop, connection);
+      }
+    }
+  } else {
+    if (op == RingSend && completion.result > 0)
+      this->consume_output(connection, completion.result);
+    else if (op == RingSend && completion.result < 0 &&
+             completion.result != -EAGAIN && completion.result != -EINTR)
+      alive = false;
+
+    alive = alive && this->flush_connection(loop, connection) &&
+            this->resume_input(loop, connection);
+  }
 
-  size_t total_received_bytes = 0;
-  size_t header_end_pos = std::string::npos;
+  if (!alive)
+    this->close_connection(loop, fd);
+  else
+    this->arm_timeout(loop, connection);
+}
 
-  const size_t MAX_HEADER_SIZE = 16384;
-  while (header_end_pos == std::string::npos &&
-         total_received_bytes < MAX_HEADER_SIZE) {
-    if (raw_request_bytes.capacity() - total_received_bytes < 4096)
-      raw_request_bytes.reserve(raw_request_bytes.capacity() + 4096);
-    raw_request_bytes.resize(total_received_bytes + 4096);
+void Weblet::accept_clients(EventLoop &loop) {
+  while (true) {
+    long long accept_started = this->metrics ? monotonic_ns() : 0;
+    sockaddr_storage client_address;
+    socklen_t client_addr_len = sizeof(client_address);
 
-    ssize_t bytes_read_chunk =
-        recv(client_socket_fd, raw_request_bytes.data() + total_received_bytes,
-             4096, 0);
+    int accepted_fd =
+        accept4(loop.listen_desc, (struct sockaddr *)&client_address,
+                &client_addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
 
-    if (bytes_read_chunk <= 0) {
-      if (total_received_bytes == 0)
-        return;
+    if (accepted_fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
 
-      this->handler_exception(
-          "Connection closed or error during header read after " +
-          std::to_string(total_received_bytes) + " bytes");
+      this->handler_exception("Failed to accept socket: " +
+                              std::string(strerror(errno)));
       break;
     }
 
-    total_received_bytes += bytes_read_chunk;
-    raw_request_bytes.resize(total_received_bytes);
+    this->add_connection(loop, accepted_fd, &client_address);
+    if (this->metrics)
+      this->metrics->record(this->routes.size(), RequestPhase::Accept,
+                            monotonic_ns() - accept_started);
+  }
+}
 
-    std::string_view current_data_view(raw_request_bytes.data(),
-                                       total_received_bytes);
-    header_end_pos = current_data_view.find("\r\n\r\n");
+void Weblet::add_connection(EventLoop &loop, int fd,
+                            const sockaddr_storage *peer) {
+  if (this->max_connections != 0 &&
+      this->open_connections >= this->max_connections) {
+    this->reject_connection(fd);
+    return;
   }
 
-  Request request;
-  Response response;
+  std::unique_ptr<Connection> connection = std::make_unique<Connection>(
+      fd, loop.next_connection_id++, monotonic_ms());
 
-  if (header_end_pos == std::string::npos) {
-    this->handler_exception("Headers too large or malformed");
-    response = this->handle_error(
-        400, "Bad Request: Request headers too large or malformed.");
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+  if (peer)
+    connection->peer = *peer;
+
+  if (loop.ring) {
+    Connection &added = *(loop.connections[fd] = std::move(connection));
+    this->open_connections++;
+    this->arm_receive(loop, added);
+    this->arm_timeout(loop, added);
 
-    this->safe_send(client_socket_fd, build_response_str(response));
     return;
   }
 
-  std::string_view full_request_view(raw_request_bytes.data(),
-                                     total_received_bytes);
-  std::string_view request_body_initial_view =
-      full_request_view.substr(header_end_pos + 4);
-  std::string request_headers_string(
-      full_request_view.substr(0, header_end_pos));
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+  event.data.fd = fd;
+
+  if (epoll_ctl(loop.epoll_desc, EPOLL_CTL_ADD, fd, &event) == -1) {
+    this->handler_exception("Failed to register socket: " +
+                            std::string(strerror(errno)));
+    return;
+  }
 
-  std::istringstream headers_only_stream(request_headers_string);
-  std::string first_line;
+  this->open_connections++;
+  this->arm_timeout(loop, *(loop.connections[fd] = std::move(connection)));
+}
 
-  std::getline(headers_only_stream, first_line);
+void Weblet::reject_connection(int fd) {
+  this->rejected_connections++;
 
-  std::istringstream first_line_stream(first_line);
-  first_line_stream >> request.method >> request.request_path;
+  send(fd, this->overload_response.data(), this->overload_response.size(),
+       MSG_DONTWAIT | MSG_NOSIGNAL);
+  shutdown(fd, SHUT_WR);
+  close(fd);
+}
 
-  if (!request.request_path.empty() && request.request_path.back() == '\r')
-    request.request_path.pop_back();
+void Weblet::service_connection(EventLoop &loop, int fd, uint32_t events) {
+  auto found = loop.connections.find(fd);
+  if (found == loop.connections.end())
+    return;
 
-  request.full_url = request.request_path;
-  this->parse_req_headers(headers_only_stream, request);
+  Connection &connection = *found->second;
+  if (events & (EPOLLERR | EPOLLHUP)) {
+    this->close_connection(loop, fd);
+    return;
+  }
 
-  long content_length = 0;
-  if (request.headers.count("Content-Length"))
-    try {
-      content_length = std::stol(request.headers["Content-Length"]);
-    } catch (const std::exception &e) {
-      this->handler_exception("Error parsing Content-Length: " +
-                              std::string(e.what()));
+  if ((events & (EPOLLIN | EPOLLRDHUP)) &&
+      !this->read_connection(loop, connection)) {
+    this->close_connection(loop, fd);
+    return;
+  }
 
-      response =
-          handle_error(400, "Bad Request: Invalid Content-Length header.");
-      this->safe_send(client_socket_fd, this->build_response_str(response));
+  if ((events & EPOLLOUT) && (!this->flush_connection(loop, connection) ||
+                              !this->resume_input(loop, connection)))
+    this->close_connection(loop, fd);
+  else
+    this->arm_timeout(loop, connection);
+}
 
-      return;
-    }
+void Weblet::deliver_completions(EventLoop &loop) {
+  for (Completion &completion : loop.take_completions()) {
+    auto found = loop.connections.find(completion.fd);
 
-  std::string request_body_str(request_body_initial_view);
-  size_t body_already_read = request_body_initial_view.length();
+    if (found == loop.connections.end() ||
+        found->second->id != completion.connection_id)
+      continue;
 
-  if (static_cast<size_t>(content_length) > body_already_read) {
-    size_t remaining_bytes_to_read = content_length - body_already_read;
-    raw_request_bytes.reserve(total_received_bytes + remaining_bytes_to_read);
+    Connection &connection = *found->second;
+    if (completion.chunk) {
+      if (connection.closing || connection.output_stream != completion.stream)
+        continue;
 
-    ssize_t read_result = this->safe_recv_to_vec(
-        client_socket_fd, raw_request_bytes, remaining_bytes_to_read);
+      ResponseStream &stream = *connection.output_stream;
+      stream.producing = false;
 
-    if (read_result < (ssize_t)remaining_bytes_to_read) {
-      if (read_result == -1) {
-        this->handler_exception("Failed to read complete request body");
-        response = this->handle_error(
-            500, "Internal Server Error: Failed to read request body.");
+      if (!completion.head.empty())
+        connection.output.push_back(std::move(completion.head));
+      if (!completion.body.empty())
+        connection.output.push_back(std::move(completion.body));
 
-        this->safe_send(client_socket_fd, this->build_response_str(response));
-        return;
+      if (stream.failed) {
+        connection.first_sequence += connection.pending.size();
+        connection.pending.clear();
+        connection.close_after_write = true;
       }
 
-      this->handler_exception("Connection closed during body read; expected " +
-                              std::to_string(remaining_bytes_to_read) +
-                              ", got " + std::to_string(read_result) +
-                              " more bytes");
+      if (stream.finished)
+        connection.output_stream.reset();
+    } else if (connection.closing ||
+               completion.sequence < connection.first_sequence ||
+        completion.sequence - connection.first_sequence >=
+            connection.pending.size())
+      continue;
+    else {
+      PendingResponse &slot =
+          connection.pending[completion.sequence - connection.first_sequence];
+      slot.ready = true;
+      slot.keep_alive = slot.keep_alive && completion.keep_alive;
+      slot.head = std::move(completion.head);
+      slot.body = std::move(completion.body);
+      slot.file = std::move(completion.file);
+      slot.stream = std::move(completion.stream);
+    }
+
+    connection.last_active = monotonic_ms();
+    if (!this->flush_connection(loop, connection) ||
+        !this->resume_input(loop, connection))
+      this->close_connection(loop, completion.fd);
+    else
+      this->arm_timeout(loop, connection);
+  }
+}
+
+void Weblet::close_connection(EventLoop &loop, int fd) {
+  auto found = loop.connections.find(fd);
+  if (found == loop.connections.end())
+    return;
+
+  Connection &connection = *found->second;
+  this->release_websocket(connection);
+  this->release_event_stream(loop, connection);
+
+  if (connection.ops_in_flight == 0) {
+    loop.connections.erase(found);
+    this->open_connections--;
+
+    return;
+  }
+
+  if (!connection.closing) {
+    connection.closing = true;
+    shutdown(fd, SHUT_RDWR);
+  }
+}
+
+void Weblet::arm_timeout(EventLoop &loop, Connection &connection) {
+  long long deadline = this->connection_deadline(connection, monotonic_ms());
+
+  if (deadline != 0 && (connection.timer_deadline == 0 ||
+                        deadline < connection.timer_deadline)) {
+    loop.timers.schedule({connection.fd, connection.id, deadline});
+    connection.timer_deadline = deadline;
+  }
+}
+
+long long Weblet::connection_deadline(Connection &connection, long long now) {
+  if (!connection.output.empty() || connection.output_file)
+    return connection.last_active + this->write_timeout * 1000LL;
+  else if (connection.websocket)
+    return connection.websocket->close_sent
+               ? connection.last_active + this->write_timeout * 1000LL
+               : 0;
+  else if (connection.event_stream)
+    return 0;
+  else if (connection.body)
+    return connection.last_active + this->body_timeout * 1000LL;
+  else if (!connection.pending.empty() || connection.output_stream)
+    return 0;
+  else if (!connection.input.empty() || connection.first_sequence == 0) {
+    if (connection.request_started == 0)
+      connection.request_started = now;
+
+    return connection.request_started + this->header_timeout * 1000LL;
+  }
+
+  connection.request_started = 0;
+  return connection.last_active + (this->keep_alive_timeout > 0
+                                       ? this->keep_alive_timeout
+                                       : WEBLET_KEEP_ALIVE_TIMEOUT_SECONDS) *
+                                      1000LL;
+}
+
+void Weblet::expire_timeouts(EventLoop &loop) {
+  long long now = monotonic_ms();
+  std::vector<TimerEntry> expired;
+
+  loop.timers.advance(now, expired);
+  for (const TimerEntry &entry : expired) {
+    auto found = loop.connections.find(entry.fd);
+
+    if (found == loop.connections.end() ||
+        found->second->id != entry.id || found->second->closing ||
+        found->second->timer_deadline != entry.deadline)
+      continue;
+
+    Connection &connection = *found->second;
+    long long deadline = this->connection_deadline(connection, now);
+
+    connection.timer_deadline = 0;
+    if (deadline == 0)
+      continue;
+    else if (deadline > now) {
+      loop.timers.schedule({entry.fd, entry.id, deadline});
+      connection.timer_deadline = deadline;
+
+      continue;
+    }
+
+    if ((connection.body || !connection.input.empty()) &&
+        connection.output.empty() && !connection.output_file) {
+      connection.body.reset();
+      connection.input.clear();
+      connection.parser.reset();
+
+      this->queue_error(connection,
+                        this->handle_error(408, "Request Timeout."));
+      if (this->flush_connection(loop, connection)) {
+        this->arm_timeout(loop, connection);
+        continue;
+      }
+    }
+
+    this->close_connection(loop, entry.fd);
+  }
+}
+
+bool Weblet::read_connection(EventLoop &loop, Connection &connection) {
+  char chunk[WEBLET_RECV_CHUNK_SIZE];
+  bool peer_closed = false;
+
+  while (true) {
+    if (connection.input.size() >= WEBLET_MAX_HEADER_SIZE) {
+      if (!this->process_input(loop, connection))
+        return false;
+      else if (this->input_full(connection)) {
+        connection.read_paused = true;
+        break;
+      }
+    }
+
+    ssize_t bytes_read = recv(connection.fd, chunk, sizeof(chunk), 0);
+
+    if (bytes_read > 0) {
+      connection.input.append(chunk, bytes_read);
+      continue;
+    } else if (bytes_read == 0) {
+      peer_closed = true;
+      break;
+    } else if (errno == EINTR)
+      continue;
+    else if (errno == EAGAIN || errno == EWOULDBLOCK)
+      break;
+
+    return false;
+  }
+
+  return this->receive_input(loop, connection, peer_closed);
+}
+
+bool Weblet::receive_input(EventLoop &loop, Connection &connection,
+                           bool peer_closed) {
+  connection.last_active = monotonic_ms();
+  if (!this->process_input(loop, connection))
+    return false;
+
+  if (peer_closed) {
+    if (connection.pending.empty() && connection.output.empty())
+      return false;
+
+    connection.close_after_write = true;
+  }
+
+  return true;
+}
+
+bool Weblet::pipeline_full(const Connection &connection) {
+  return connection.close_after_write ||
+         connection.pending.size() + connection.output.size() / 2 >=
+             WEBLET_MAX_PIPELINED_REQUESTS;
+}
+
+bool Weblet::input_full(const Connection &connection) {
+  return connection.input.size() >= WEBLET_MAX_HEADER_SIZE &&
+         !connection.websocket && !connection.event_stream;
+}
+
+bool Weblet::resume_input(EventLoop &loop, Connection &connection) {
+  if (connection.closing)
+    return true;
+  else if (!connection.input.empty() && !this->process_input(loop, connection))
+    return false;
+  else if (!connection.read_paused || this->input_full(connection))
+    return true;
+
+  connection.read_paused = false;
+  if (!loop.ring)
+    return this->read_connection(loop, connection);
+
+  this->arm_receive(loop, connection);
+  return true;
+}
+
+void Weblet::arm_receive(EventLoop &loop, Connection &connection) {
+  if (connection.receiving || connection.awaiting_buffer)
+    return;
+
+  loop.ring->prepare_poll(connection.fd, POLLIN,
+                          ring_data(RingReadable, connection.fd));
+  connection.receiving = true;
+  connection.ops_in_flight++;
+}
+
+void Weblet::start_read(EventLoop &loop, Connection &connection) {
+  if (connection.receiving || connection.awaiting_buffer)
+    return;
+  else if (loop.free_buffers.empty()) {
+    connection.awaiting_buffer = true;
+    loop.buffer_waiters.push_back(connection.fd);
+
+    return;
+  }
+
+  unsigned index = loop.free_buffers.back();
+  char *buffer = loop.receive_buffers.data() +
+                 static_cast<size_t>(index) * WEBLET_RECV_CHUNK_SIZE;
+
+  loop.free_buffers.pop_back();
+  connection.receive_buffer = static_cast<int>(index);
+  connection.receiving = true;
+  connection.ops_in_flight++;
+
+  if (loop.buffers_registered)
+    loop.ring->prepare_read_fixed(connection.fd, buffer,
+                                  WEBLET_RECV_CHUNK_SIZE, index,
+                                  ring_data(RingRead, connection.fd));
+  else
+    loop.ring->prepare_read(connection.fd, buffer, WEBLET_RECV_CHUNK_SIZE,
+                            ring_data(RingRead, connection.fd));
+}
+
+void Weblet::release_buffer(EventLoop &loop, Connection &connection) {
+  loop.free_buffers.push_back(static_cast<unsigned>(connection.receive_buffer));
+  connection.receive_buffer = -1;
+
+  while (!loop.free_buffers.empty() && !loop.buffer_waiters.empty()) {
+    auto waiter = loop.connections.find(loop.buffer_waiters.front());
+    loop.buffer_waiters.pop_front();
+
+    if (waiter == loop.connections.end() || !waiter->second->awaiting_buffer)
+      continue;
+
+    waiter->second->awaiting_buffer = false;
+    if (!waiter->second->closing)
+      this->start_read(loop, *waiter->second);
+  }
+}
+
+bool Weblet::process_input(EventLoop &loop, Connection &connection) {
+  while (!connection.websocket && !connection.event_stream &&
+         !this->pipeline_full(connection)) {
+    if (connection.body) {
+      if (!this->receive_body(connection))
+        break;
+
+      if (this->metrics)
+        this->metrics->record(connection.trace.route, RequestPhase::BodyRead,
+                              monotonic_ns() - connection.trace.body_started);
+
+      std::unique_ptr<BodyReceiver> receiver = std::move(connection.body);
+      this->dispatch_request(loop, connection, std::move(receiver->request),
+                             receiver->keep_alive);
+      continue;
+    }
+
+    long long parse_started = 0;
+    if (this->metrics && !connection.input.empty()) {
+      parse_started = monotonic_ns();
+      if (connection.trace.head_started == 0)
+        connection.trace.head_started = parse_started;
+    }
+
+    HttpParseStatus status = connection.parser.parse(connection.input);
+
+    if (status == HttpParseStatus::Incomplete)
+      break;
+    else if (status == HttpParseStatus::Error) {
+      this->handler_exception(connection.parser.error());
+      this->queue_error(connection,
+                        this->handle_error(400, std::string("Bad Request: ") +
+                                                    connection.parser.error() +
+                                                    "."));
+      break;
+    }
+
+    const HttpRequestHead &head = connection.parser.head();
+    std::string_view length_header = head.header("Content-Length");
+    bool chunked = iequals(head.header("Transfer-Encoding"), "chunked");
+    size_t content_length = 0;
+
+    if (!chunked && !length_header.empty()) {
+      auto [end, error_code] =
+          std::from_chars(length_header.data(),
+                          length_header.data() + length_header.size(),
+                          content_length);
+
+      if (error_code != std::errc() ||
+          end != length_header.data() + length_header.size()) {
+        this->handler_exception("Error parsing Content-Length: " +
+                                std::string(length_header));
+        this->queue_error(
+            connection,
+            this->handle_error(400,
+                               "Bad Request: Invalid Content-Length header."));
+
+        break;
+      }
+    } else if (!chunked && !head.header("Transfer-Encoding").empty()) {
+      this->handler_exception("Unsupported Transfer-Encoding: " +
+                              std::string(head.header("Transfer-Encoding")));
+      this->queue_error(
+          connection,
+          this->handle_error(501, "Not Implemented: Unsupported "
+                                  "Transfer-Encoding."));
+
+      break;
+    }
+
+    Request request;
+    this->build_request(head, request);
+    request.remote_address = connection.peer_address();
+    if (this->metrics)
+      connection.trace.route =
+          this->trace_head(connection, request, parse_started);
+
+    connection.input.erase(0, connection.parser.head_length());
+    connection.parser.reset();
+    connection.request_started = 0;
+
+    bool keep_alive = this->wants_keep_alive(request);
+    if (chunked || content_length > 0) {
+      if (this->metrics)
+        connection.trace.body_started = monotonic_ns();
+      if (!this->start_body(connection, std::move(request), keep_alive,
+                            content_length, chunked))
+        break;
+
+      continue;
+    }
+
+    this->parse_request_body(request);
+    this->dispatch_request(loop, connection, std::move(request), keep_alive);
+  }
+
+  if (connection.websocket)
+    this->receive_frames(connection);
+  else if (connection.event_stream)
+    connection.input.clear();
+
+  return this->flush_connection(loop, connection);
+}
+
+bool Weblet::start_body(Connection &connection, Request request,
+                        bool keep_alive, size_t content_length, bool chunked) {
+  if (this->max_body_size != 0 && content_length > this->max_body_size) {
+    this->handler_exception("Request body too large: " +
+                            std::to_string(content_length) + " bytes");
+    this->queue_error(connection,
+                      this->handle_error(413, "Payload Too Large: Request "
+                                              "body exceeds the size limit."));
+
+    return false;
+  }
+
+  auto receiver =
+      std::make_unique<BodyReceiver>(std::move(request), keep_alive);
+  receiver->chunked = chunked;
+  receiver->remaining = content_length;
+
+  auto content_type = receiver->request.headers.find("Content-Type");
+  if (content_type != receiver->request.headers.end() &&
+      content_type->second.rfind("multipart/form-data", 0) == 0) {
+    std::string boundary;
+
+    if (!header_parameter(content_type->second, "boundary", boundary) ||
+        boundary.empty()) {
+      this->handler_exception("Multipart form-data without boundary");
+      this->queue_error(
+          connection,
+          this->handle_error(400, "Bad Request: Malformed "
+                                  "multipart/form-data (missing boundary)."));
+
+      return false;
+    }
+
+    BodyReceiver *target = receiver.get();
+    receiver->multipart = std::make_unique<MultipartParser>(
+        boundary,
+        [this, target](const HeaderMap &headers) {
+          return this->begin_part(*target, headers);
+        },
+        [this, target](std::string_view data) {
+          return this->store_part(*target, data);
+        },
+        [this, target]() { return this->end_part(*target); });
+  }
+
+  auto expect = receiver->request.headers.find("Expect");
+  if (expect != receiver->request.headers.end() &&
+      strcasecmp(expect->second.c_str(), "100-continue") == 0 &&
+      receiver->request.version == "HTTP/1.1" && connection.pending.empty() &&
+      !connection.output_file && !connection.output_stream)
+    connection.output.push_back(std::string("HTTP/1.1 100 Continue\r\n\r\n"));
+
+  connection.body = std::move(receiver);
+  return true;
+}
+
+bool Weblet::receive_body(Connection &connection) {
+  BodyReceiver &receiver = *connection.body;
+  std::string_view input(connection.input);
+  size_t used = 0;
+  bool complete = false;
+
+  if (receiver.chunked)
+    while (receiver.error_code == 0) {
+      size_t consumed = 0;
+      std::string_view data;
+      HttpParseStatus status =
+          receiver.decoder.next(input.substr(used), consumed, data);
+
+      used += consumed;
+      if (status == HttpParseStatus::Error)
+        receiver.fail(400, "Bad Request: Malformed chunked body.");
+      else if (status == HttpParseStatus::Complete) {
+        complete = true;
+        break;
+      } else if (!data.empty()) {
+        receiver.decoded += data.size();
+
+        if (this->max_body_size != 0 &&
+            receiver.decoded > this->max_body_size)
+          receiver.fail(413, "Payload Too Large: Request body exceeds the "
+                             "size limit.");
+        else
+          this->store_body(receiver, data);
+      } else if (consumed == 0)
+        break;
+    }
+  else {
+    used = std::min(receiver.remaining, input.size());
+    if (used > 0)
+      this->store_body(receiver, input.substr(0, used));
+
+    receiver.remaining -= used;
+    complete = receiver.remaining == 0;
+  }
+
+  connection.input.erase(0, used);
+  if (complete && receiver.multipart && !receiver.multipart->complete())
+    receiver.fail(400, "Bad Request: Malformed multipart/form-data body.");
+
+  if (receiver.error_code != 0) {
+    this->handler_exception(receiver.error_message);
+    this->queue_error(connection, this->handle_error(receiver.error_code,
+                                                     receiver.error_message));
+
+    connection.body.reset();
+    return false;
+  }
+
+  if (complete)
+    this->parse_request_body(receiver.request);
+
+  return complete;
+}
+
+bool Weblet::store_body(BodyReceiver &receiver, std::string_view data) {
+  if (receiver.multipart) {
+    try {
+      if (!receiver.multipart->feed(data))
+        return receiver.fail(
+            400, "Bad Request: Malformed multipart/form-data body.");
+    } catch (const std::exception &e) {
+      return receiver.fail(500, "Upload failed: " + std::string(e.what()));
+    }
+
+    return true;
+  }
+
+  Request &request = receiver.request;
+  if (!request.spooled_body &&
+      request.contents.size() + data.size() > this->body_spool_threshold) {
+    request.spooled_body = TempFile::create(this->upload_directory);
+
+    if (!request.spooled_body || !request.spooled_body->write(request.contents))
+      return receiver.fail(500, "Could not spool request body.");
+
+    std::string().swap(request.contents);
+  }
+
+  if (!request.spooled_body) {
+    request.contents.append(data);
+    return true;
+  } else if (!request.spooled_body->write(data))
+    return receiver.fail(500, "Could not spool request body.");
+
+  return true;
+}
+
+bool Weblet::begin_part(BodyReceiver &receiver, const HeaderMap &headers) {
+  receiver.part_name.clear();
+  receiver.part_skipped = receiver.part_is_file = false;
+  receiver.part_value.clear();
+  receiver.part_file = UploadedFile();
+  receiver.part_sink.reset();
+
+  auto disposition = headers.find("Content-Disposition");
+  if (disposition == headers.end()) {
+    this->handler_exception(
+        "Multipart part without Content-Disposition header; skipping part");
+
+    receiver.part_skipped = true;
+    return true;
+  } else if (!header_parameter(disposition->second, "name",
+                               receiver.part_name)) {
+    this->handler_exception("Multipart part Content-Disposition without "
+                            "'name' attribute; skipping part");
+
+    receiver.part_skipped = true;
+    return true;
+  }
+
+  if (!header_parameter(disposition->second, "filename",
+                        receiver.part_file.filename) ||
+      receiver.part_file.filename.empty())
+    return true;
+
+  auto content_type = headers.find("Content-Type");
+  receiver.part_is_file = true;
+  receiver.part_file.content_type = content_type != headers.end()
+                                        ? content_type->second
+                                        : "application/octet-stream";
+
+  if (this->upload_sink)
+    receiver.part_sink = this->upload_sink(
+        receiver.request, receiver.part_name, receiver.part_file);
+
+  return true;
+}
+
+bool Weblet::store_part(BodyReceiver &receiver, std::string_view data) {
+  if (receiver.part_skipped)
+    return true;
+  else if (!receiver.part_is_file) {
+    if (receiver.part_value.size() + data.size() > this->body_spool_threshold)
+      return receiver.fail(413, "Payload Too Large: Form field exceeds the "
+                                "body size limit.");
+
+    receiver.part_value.append(data);
+    return true;
+  }
+
+  UploadedFile &file = receiver.part_file;
+  file.size += data.size();
+
+  if (receiver.part_sink)
+    return receiver.part_sink->write(data) ||
+           receiver.fail(500, "Upload sink rejected the file.");
+
+  if (!file.spooled &&
+      file.data.size() + data.size() > this->body_spool_threshold) {
+    file.spooled = TempFile::create(this->upload_directory);
+
+    if (!file.spooled ||
+        !file.spooled->write(std::string_view(
+            reinterpret_cast<const char *>(file.data.data()),
+            file.data.size())))
+      return receiver.fail(500, "Could not spool uploaded file.");
+
+    std::vector<uint8_t>().swap(file.data);
+  }
+
+  if (!file.spooled) {
+    file.data.insert(file.data.end(), data.begin(), data.end());
+    return true;
+  }
+
+  return file.spooled->write(data) ||
+         receiver.fail(500, "Could not spool uploaded file.");
+}
+
+bool Weblet::end_part(BodyReceiver &receiver) {
+  Request &request = receiver.request;
+
+  if (receiver.part_skipped)
+    return true;
+  else if (!receiver.part_is_file) {
+    request.form_fields[receiver.part_name] = std::move(receiver.part_value);
+    return true;
+  }
+
+  if (receiver.part_sink) {
+    if (!receiver.part_sink->finish(receiver.part_file))
+      return receiver.fail(500, "Upload sink rejected the file.");
+
+    receiver.part_sink.reset();
+  }
+
+  request.upload_files[receiver.part_name] = std::move(receiver.part_file);
+  return true;
+}
+
+static void begin_file(Connection &connection,
+                       std::shared_ptr<ResponseFile> file) {
+  if (!file->prefix.empty())
+    connection.output.push_back(file->prefix);
+
+  connection.file_offset = file->offset;
+  connection.file_remaining = file->length;
+  connection.output_file = std::move(file);
+}
+
+bool Weblet::flush_connection(EventLoop &loop, Connection &connection) {
+  while (true) {
+    while (!connection.output_file && !connection.output_stream &&
+           !connection.pending.empty() && connection.pending.front().ready) {
+      PendingResponse &slot = connection.pending.front();
+      bool keep_alive = slot.keep_alive;
+
+      if (this->metrics && connection.trace.send_started == 0) {
+        connection.trace.send_started = monotonic_ns();
+        connection.trace.send_route = slot.route;
+      }
+
+      connection.output.push_back(std::move(slot.head));
+      if (!slot.body.empty())
+        connection.output.push_back(std::move(slot.body));
+
+      if (slot.file)
+        begin_file(connection, std::move(slot.file));
+
+      connection.output_stream = std::move(slot.stream);
+      connection.pending.pop_front();
+      connection.first_sequence++;
+
+      if (!keep_alive) {
+        connection.first_sequence += connection.pending.size();
+        connection.pending.clear();
+        connection.close_after_write = true;
+      }
+    }
+
+    if (!this->write_output(loop, connection))
+      return false;
+    else if (connection.output_stream) {
+      this->produce_chunk(loop, connection);
+      return true;
+    } else if (!connection.output.empty())
+      return true;
+
+    if (!connection.output_file) {
+      if (this->metrics && connection.trace.send_started != 0) {
+        this->metrics->record(connection.trace.send_route, RequestPhase::Send,
+                              monotonic_ns() - connection.trace.send_started);
+        connection.trace.send_started = 0;
+      }
+
+      break;
+    } else if (!this->send_file_body(loop, connection))
+      return false;
+    else if (connection.file_remaining > 0)
+      return true;
+
+    std::shared_ptr<ResponseFile> next = connection.output_file->next;
+    connection.output_file.reset();
+
+    if (next)
+      begin_file(connection, std::move(next));
+  }
+
+  return !(connection.close_after_write && connection.pending.empty());
+}
+
+void Weblet::produce_chunk(EventLoop &loop, Connection &connection) {
+  if (connection.output_stream->producing)
+    return;
+
+  size_t buffered = 0;
+  for (const OutputSegment &segment : connection.output)
+    buffered += segment.size();
+
+  if (buffered - connection.output_offset >= WEBLET_STREAM_BUFFER_LIMIT)
+    return;
+
+  connection.output_stream->producing = true;
+  if (connection.output_stream->async_producer) {
+    Purple::Concurrent::go<std::function<void()>>(
+        &this->tasklet_manager,
+        [this, target = &loop, id = connection.id, fd = connection.fd,
+         stream = connection.output_stream] {
+          std::shared_ptr<std::string> chunk = std::make_shared<std::string>();
+          std::optional<Task<bool>> task;
+
+          try {
+            task.emplace(stream->async_producer(*chunk));
+          } catch (const std::exception &e) {
+            this->handler_exception("Response stream failed: " +
+                                    std::string(e.what()));
+
+            stream->failed = true;
+            this->post_chunk(target, id, fd, stream, std::string(), false);
+            return;
+          }
+
+          Purple::Concurrent::spawn(
+              std::move(*task), [this, target, id, fd, stream,
+                                 chunk](std::optional<bool> more,
+                                        std::exception_ptr error) {
+                if (error) {
+                  this->report_exception("Response stream failed", error);
+
+                  chunk->clear();
+                  stream->failed = true;
+                }
+
+                this->post_chunk(target, id, fd, stream, std::move(*chunk),
+                                 more.value_or(false));
+              });
+        });
+
+    return;
+  }
+
+  Purple::Concurrent::go<std::function<void()>>(
+      &this->tasklet_manager,
+      [this, target = &loop, id = connection.id, fd = connection.fd,
+       stream = connection.output_stream] {
+        std::string chunk;
+        bool more = false;
+
+        try {
+          more = stream->producer(chunk);
+        } catch (const std::exception &e) {
+          this->handler_exception("Response stream failed: " +
+                                  std::string(e.what()));
+
+          chunk.clear();
+          stream->failed = true;
+        }
+
+        this->post_chunk(target, id, fd, stream, std::move(chunk), more);
+      });
+}
+
+void Weblet::post_chunk(EventLoop *target, uint64_t id, int fd,
+                        std::shared_ptr<ResponseStream> stream,
+                        std::string chunk, bool more) {
+  std::string frame;
+  if (stream->chunked && !chunk.empty()) {
+    char size[24];
+    snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+
+    frame.append(stream->started ? "\r\n" : "").append(size);
+    stream->started = true;
+  }
+
+  if (!more) {
+    stream->finished = true;
+
+    if (stream->chunked && !stream->failed)
+      chunk.append(stream->started ? "\r\n0\r\n\r\n" : "0\r\n\r\n");
+  }
+
+  target->post({id, fd, 0, false, std::move(frame), std::move(chunk), nullptr,
+                std::move(stream), true});
+}
+
+bool Weblet::write_output(EventLoop &loop, Connection &connection) {
+  while (!connection.output.empty() && !connection.sending) {
+    std::vector<iovec> &iov = connection.send_iov;
+    iov.clear();
+
+    for (const OutputSegment &segment : connection.output) {
+      size_t skip = iov.empty() ? connection.output_offset : 0;
+      iov.push_back({const_cast<char *>(segment.data()) + skip,
+                     segment.size() - skip});
+
+      if (iov.size() == WEBLET_MAX_IOVECS)
+        break;
+    }
+
+    connection.send_message = {};
+    connection.send_message.msg_iov = iov.data();
+    connection.send_message.msg_iovlen = iov.size();
+
+    if (loop.ring) {
+      loop.ring->prepare_sendmsg(connection.fd, &connection.send_message,
+                                 ring_data(RingSend, connection.fd));
+      connection.sending = true;
+      connection.ops_in_flight++;
+
+      break;
+    }
+
+    ssize_t bytes_sent =
+        sendmsg(connection.fd, &connection.send_message, MSG_NOSIGNAL);
+    if (bytes_sent < 0) {
+      if (errno == EINTR)
+        continue;
+
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    this->consume_output(connection, static_cast<size_t>(bytes_sent));
+  }
+
+  return true;
+}
+
+void Weblet::consume_output(Connection &connection, size_t written) {
+  while (written > 0) {
+    size_t left = connection.output.front().size() - connection.output_offset;
+
+    if (written < left) {
+      connection.output_offset += written;
+      break;
+    }
+
+    written -= left;
+    connection.output.pop_front();
+    connection.output_offset = 0;
+  }
+
+  connection.last_active = monotonic_ms();
+}
+
+bool Weblet::send_file_body(EventLoop &loop, Connection &connection) {
+  while (connection.file_remaining > 0) {
+    ssize_t bytes_sent =
+        sendfile(connection.fd, connection.output_file->fd,
+                 &connection.file_offset,
+                 std::min<size_t>(connection.file_remaining, 1 << 30));
+
+    if (bytes_sent > 0) {
+      connection.file_remaining -= bytes_sent;
+      connection.last_active = monotonic_ms();
+    }
+    else if (bytes_sent == 0) {
+      this->handler_exception("File ended before its response was sent");
+      return false;
+    } else if (errno == EINTR)
+      continue;
+    else if (errno != EAGAIN && errno != EWOULDBLOCK)
+      return false;
+
+    if (loop.ring && !connection.sending) {
+      loop.ring->prepare_poll(connection.fd, POLLOUT,
+                              ring_data(RingWritable, connection.fd));
+      connection.sending = true;
+      connection.ops_in_flight++;
+    }
+
+    return true;
+  }
+
+  return true;
+}
+
+void Weblet::queue_error(Connection &connection, Response response) {
+  connection.pending.push_back({true, false,
+                                this->build_response_head(response),
+                                std::move(response.contents), response.file,
+                                nullptr, this->routes.size()});
+  connection.close_after_write = true;
+}
+
+void Weblet::dispatch_request(EventLoop &loop, Connection &connection,
+                              Request request, bool keep_alive) {
+  uint64_t sequence = connection.first_sequence + connection.pending.size();
+  connection.pending.push_back({false, keep_alive, std::string(),
+                                std::string(), nullptr, nullptr,
+                                connection.trace.route});
+
+  if (!keep_alive)
+    connection.close_after_write = true;
+
+  std::string cache_key;
+  std::shared_ptr<const CachePolicy> cache_policy;
+
+  if (this->rate_limiter &&
+      this->limit_request(connection, request, keep_alive))
+    return;
+  else if (this->websocket_routes &&
+           this->upgrade_websocket(loop, connection, request))
+    return;
+  else if (this->sse_routes &&
+           this->subscribe_events(loop, connection, request))
+    return;
+  else if (this->response_cache && request.method == "GET" &&
+           this->serve_cached(loop, connection, request, keep_alive,
+                              cache_key, cache_policy))
+    return;
+
+  if (!this->submit_request(&loop, connection.id, connection.fd, sequence,
+                            keep_alive, std::move(request), cache_key,
+                            cache_policy)) {
+    this->reject_request(connection);
+    this->complete_cache(cache_key, nullptr);
+  }
+}
+
+bool Weblet::submit_request(EventLoop *target, uint64_t id, int fd,
+                            uint64_t sequence, bool keep_alive,
+                            Request request, std::string cache_key,
+                            std::shared_ptr<const CachePolicy> policy) {
+  if (this->max_inflight_requests != 0 &&
+      this->inflight_requests >= this->max_inflight_requests)
+    return false;
+
+  this->inflight_requests++;
+  bool queued = this->tasklet_manager.try_go(
+      [this, target, id, fd, sequence, keep_alive,
+       request = std::move(request), cache_key = std::move(cache_key),
+       policy = std::move(policy)]() mutable {
+        this->run_request(target, id, fd, sequence, keep_alive, request,
+                          cache_key, policy);
+      },
+      this->max_queued_tasks);
+
+  if (!queued)
+    this->inflight_requests--;
+  return queued;
+}
+
+void Weblet::run_request(EventLoop *target, uint64_t id, int fd,
+                         uint64_t sequence, bool keep_alive, Request &request,
+                         const std::string &cache_key,
+                         const std::shared_ptr<const CachePolicy> &policy) {
+  RouteMatch match;
+
+  if (policy && cache_key.empty() &&
+      this->router.match(request.request_path, match)) {
+    this->run_cached_request(target, id, fd, sequence, keep_alive, request,
+                             this->routes[match.route], policy);
+    return;
+  } else if (this->async_routes &&
+             this->router.match(request.request_path, match) &&
+             this->routes[match.route].async_handler) {
+    this->run_async_request(target, id, fd, sequence, keep_alive, request,
+                            this->routes[match.route], cache_key, policy);
+    return;
+  }
+
+  Response response;
+  size_t route_slot = this->routes.size();
+  long long started = this->metrics ? monotonic_ns() : 0;
+
+  try {
+    response = this->route_request(request, route_slot);
+  } catch (const std::exception &e) {
+    this->handler_exception("Request handler failed: " +
+                            std::string(e.what()));
+    response = this->handle_error(500, "Request handler failed.");
+  }
+
+  if (this->metrics)
+    this->metrics->record(route_slot, RequestPhase::Handler,
+                          monotonic_ns() - started);
+
+  this->finish_request(target, id, fd, sequence, keep_alive, request,
+                       cache_key, policy, std::move(response));
+}
+
+void Weblet::run_async_request(
+    EventLoop *target, uint64_t id, int fd, uint64_t sequence,
+    bool keep_alive, Request &request, const Route &route,
+    const std::string &cache_key,
+    const std::shared_ptr<const CachePolicy> &policy) {
+  std::shared_ptr<AsyncCall> call = std::make_shared<AsyncCall>(
+      std::move(request), route, this->config_snapshot(), this->scheduler);
+  this->router.match(call->request.request_path, call->match);
+
+  const MiddlewareChain *chain = route.middleware.get();
+  size_t route_slot = &route - this->routes.data();
+  long long started = this->metrics ? monotonic_ns() : 0;
+  std::optional<Task<Response>> task;
+  Response response;
+  size_t entered = 0;
+
+  if (this->enter_middleware(chain, call->context, response, entered)) {
+    try {
+      task.emplace(route.async_handler(call->context));
+    } catch (const std::exception &e) {
+      this->handler_exception("Request handler failed: " +
+                              std::string(e.what()));
+      response = this->handle_error(500, "Request handler failed.");
+    }
+  }
+
+  if (!task) {
+    this->leave_middleware(chain, entered, call->context, response);
+    if (this->metrics)
+      this->metrics->record(route_slot, RequestPhase::Handler,
+                            monotonic_ns() - started);
+
+    this->finish_request(target, id, fd, sequence, keep_alive, call->request,
+                         cache_key, policy, std::move(response));
+    return;
+  }
+
+  Purple::Concurrent::spawn(
+      std::move(*task),
+      [this, target, id, fd, sequence, keep_alive, call, cache_key, policy,
+       chain, entered, route_slot,
+       started](std::optional<Response> response, std::exception_ptr error) {
+        if (error) {
+          this->report_exception("Request handler failed", error);
+          response = this->handle_error(500, "Request handler failed.");
+        }
+
+        this->leave_middleware(chain, entered, call->context, *response);
+        if (this->metrics)
+          this->metrics->record(route_slot, RequestPhase::Handler,
+                                monotonic_ns() - started);
+
+        this->finish_request(target, id, fd, sequence, keep_alive,
+                             call->request, cache_key, policy,
+                             std::move(*response));
+      });
+}
+
+void Weblet::run_cached_request(
+    EventLoop *target, uint64_t id, int fd, uint64_t sequence,
+    bool keep_alive, Request &request, const Route &route,
+    const std::shared_ptr<const CachePolicy> &policy) {
+  std::shared_ptr<AsyncCall> call = std::make_shared<AsyncCall>(
+      std::move(request), route, this->config_snapshot(), this->scheduler);
+  this->router.match(call->request.request_path, call->match);
+
+  const MiddlewareChain *chain = route.middleware.get();
+  size_t route_slot = &route - this->routes.data();
+  long long started = this->metrics ? monotonic_ns() : 0;
+  Response response;
+  size_t entered = 0;
+  bool passed = this->enter_middleware(chain, call->context, response, entered);
+
+  auto respond = [this, target, id, fd, sequence, keep_alive, call, chain,
+                  entered, route_slot, started](Response response) {
+    this->leave_middleware(chain, entered, call->context, response);
+    if (this->metrics)
+      this->metrics->record(route_slot, RequestPhase::Handler,
+                            monotonic_ns() - started);
+
+    this->finish_request(target, id, fd, sequence, keep_alive, call->request,
+                         std::string(), nullptr, std::move(response));
+  };
+
+  if (!passed) {
+    respond(std::move(response));
+    return;
+  }
+
+  std::string key = this->build_cache_key(*policy, call->request);
+  std::shared_ptr<const CachedResponse> entry;
+
+  CacheLookup outcome = this->response_cache->lookup(
+      key, monotonic_ms(), entry, [&]() -> CacheWaiter {
+        return [this, call, handled = &route,
+                respond](std::shared_ptr<const CachedResponse> produced) {
+          if (produced) {
+            respond(this->cached_response(*produced));
+            return;
+          }
+
+          if (!this->tasklet_manager.try_go(
+                  [this, call, handled, respond]() {
+                    respond(this->invoke_handler(*handled, call->context));
+                  },
+                  this->max_queued_tasks)) {
+            Response overload =
+                this->handle_error(503, "Server is overloaded.");
+            overload.set_header("Retry-After",
+                                std::to_string(this->retry_after));
+            overload.set_header("Connection", "close");
+
+            this->rejected_requests++;
+            respond(std::move(overload));
+          }
+        };
+      });
+
+  if (outcome == CacheLookup::Pending)
+    return;
+  else if (outcome != CacheLookup::Miss) {
+    respond(this->cached_response(*entry));
+    if (outcome == CacheLookup::Hit)
+      return;
+  }
+
+  response = this->invoke_handler(route, call->context);
+  if (this->compression_enabled)
+    this->compress_response(call->request, response);
+  this->complete_cache(key, this->cache_entry(*policy, response));
+
+  if (outcome == CacheLookup::Miss)
+    respond(std::move(response));
+}
+
+Response Weblet::invoke_handler(const Route &route,
+                                const RequestContext &context) {
+  try {
+    return route.handler(context);
+  } catch (const std::exception &e) {
+    this->handler_exception("Request handler failed: " +
+                            std::string(e.what()));
+    return this->handle_error(500, "Request handler failed.");
+  }
+}
+
+void Weblet::report_exception(const std::string &context,
+                              std::exception_ptr error) {
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::exception &e) {
+    this->handler_exception(context + ": " + std::string(e.what()));
+  } catch (...) {
+    this->handler_exception(context + ".");
+  }
+}
+
+void Weblet::finish_request(EventLoop *target, uint64_t id, int fd,
+                            uint64_t sequence, bool keep_alive,
+                            const Request &request,
+                            const std::string &cache_key,
+                            const std::shared_ptr<const CachePolicy> &policy,
+                            Response response) {
+  this->inflight_requests--;
+  if (this->compression_enabled)
+    this->compress_response(request, response);
+
+  if (!cache_key.empty())
+    this->complete_cache(cache_key, this->cache_entry(*policy, response));
+
+  if (!target)
+    return;
+
+  bool persist = keep_alive;
+  if (response.headers.count("Connection") &&
+      strcasecmp(response.headers["Connection"].c_str(), "close") == 0)
+    persist = false;
+
+  const std::string &version = request.version;
+  bool chunked = version != "HTTP/1.0";
+  if (response.streamed()) {
+    if (chunked)
+      response.set_header("Transfer-Encoding", "chunked");
+    else
+      persist = false;
+  }
+
+  response.set_header("Connection", persist ? "keep-alive" : "close");
+  if (persist && version == "HTTP/1.0")
+    response.set_header("Keep-Alive",
+                        "timeout=" + std::to_string(this->keep_alive_timeout));
+
+  if (response.file || response.streamed())
+    response.contents.clear();
+
+  std::string head = this->build_response_head(response);
+  std::shared_ptr<ResponseStream> stream;
+
+  if (response.stream)
+    stream = std::make_shared<ResponseStream>(std::move(response.stream),
+                                              chunked);
+  else if (response.async_stream)
+    stream = std::make_shared<ResponseStream>(
+        std::move(response.async_stream), chunked);
+
+  target->post({id, fd, sequence, persist, std::move(head),
+                std::move(response.contents), std::move(response.file),
+                std::move(stream), false});
+}
+
+void Weblet::compress_response(const Request &request, Response &response) {
+  auto content_type = response.headers.find("Content-Type");
+
+  if (!response.compress || response.file || response.streamed() ||
+      response.contents.size() < this->compression_min_size ||
+      response.status_code < 200 || response.status_code == 204 ||
+      response.status_code == 206 ||
+      response.headers.count("Content-Encoding") ||
+      content_type == response.headers.end() ||
+      !is_compressible_type(content_type->second))
+    return;
+
+  auto vary = response.headers.find("Vary");
+  if (vary == response.headers.end())
+    response.set_header("Vary", "Accept-Encoding");
+  else if (vary->second != "*" && !has_token(vary->second, "Accept-Encoding"))
+    vary->second.append(", Accept-Encoding");
+
+  auto accept_encoding = request.headers.find("Accept-Encoding");
+  if (accept_encoding == request.headers.end())
+    return;
+
+  ContentCoding coding = negotiate_coding(accept_encoding->second);
+  std::string encoded;
+
+  if (!compress_body(coding, response.contents, this->compression_level,
+                     encoded))
+    return;
+
+  response.contents.swap(encoded);
+  response.set_header("Content-Encoding", coding_name(coding));
+
+  auto etag = response.headers.find("ETag");
+  if (etag != response.headers.end() && etag->second.size() >= 2 &&
+      etag->second.back() == '"')
+    etag->second.insert(etag->second.size() - 1,
+                        std::string("-") + coding_name(coding));
+}
+
+bool Weblet::serve_cached(EventLoop &loop, Connection &connection,
+                          Request &request, bool keep_alive,
+                          std::string &cache_key,
+                          std::shared_ptr<const CachePolicy> &policy) {
+  RouteMatch match;
+  if (!this->router.match(request.request_path, match) ||
+      !this->routes[match.route].cache)
+    return false;
+
+  policy = this->routes[match.route].cache;
+  if (this->routes[match.route].middleware)
+    return false;
+
+  std::string key = this->build_cache_key(*policy, request);
+  std::shared_ptr<const CachedResponse> entry;
+  uint64_t sequence =
+      connection.first_sequence + connection.pending.size() - 1;
+
+  CacheLookup outcome = this->response_cache->lookup(
+      key, monotonic_ms(), entry, [&]() -> CacheWaiter {
+        return [this, target = &loop, id = connection.id, fd = connection.fd,
+                sequence, keep_alive, request = std::move(request)](
+                   std::shared_ptr<const CachedResponse> produced) mutable {
+          if (produced) {
+            target->post({id, fd, sequence, keep_alive,
+                          this->cached_head(*produced, keep_alive,
+                                            request.version),
+                          produced->body, nullptr, nullptr, false});
+            return;
+          }
+
+          if (!this->submit_request(target, id, fd, sequence, keep_alive,
+                                    std::move(request), std::string(),
+                                    nullptr)) {
+            target->post({id, fd, sequence, false, this->overload_response,
+                          std::string(), nullptr, nullptr, false});
+            this->rejected_requests++;
+          }
+        };
+      });
+
+  if (outcome == CacheLookup::Miss) {
+    cache_key = std::move(key);
+    return false;
+  } else if (outcome == CacheLookup::Pending)
+    return true;
+
+  PendingResponse &slot = connection.pending.back();
+  slot.ready = true;
+  slot.head = this->cached_head(*entry, keep_alive, request.version);
+  slot.body = entry->body;
+
+  if (outcome == CacheLookup::Refresh &&
+      !this->submit_request(nullptr, 0, -1, 0, false, std::move(request), key,
+                            policy))
+    this->complete_cache(key, nullptr);
+
+  return true;
+}
+
+void Weblet::complete_cache(const std::string &key,
+                            std::shared_ptr<const CachedResponse> entry) {
+  if (key.empty())
+    return;
+
+  for (CacheWaiter &waiter : this->response_cache->complete(key, entry))
+    waiter(entry);
+}
+
+std::string Weblet::build_cache_key(const CachePolicy &policy,
+                                    const Request &request) {
+  std::string key = request.request_path;
+
+  for (const std::string &name : policy.query_params) {
+    std::string_view query(request.query), value;
+
+    while (!query.empty()) {
+      size_t separator = query.find('&');
+      std::string_view parameter = query.substr(0, separator);
+
+      query = separator == std::string_view::npos
+                  ? std::string_view()
+                  : query.substr(separator + 1);
+
+      size_t equals = parameter.find('=');
+      if (parameter.substr(0, equals) == name) {
+        value = equals == std::string_view::npos ? std::string_view()
+                                                 : parameter.substr(equals + 1);
+        break;
+      }
+    }
+
+    key.append("\n").append(name).append("=").append(value);
+  }
+
+  for (const std::string &name : policy.vary) {
+    auto header = request.headers.find(name);
+
+    key.append("\n").append(name).append(":");
+    if (header != request.headers.end())
+      key.append(header->second);
+  }
+
+  if (this->compression_enabled) {
+    auto accept_encoding = request.headers.find("Accept-Encoding");
+
+    key.append("\n").append(coding_name(negotiate_coding(
+        accept_encoding != request.headers.end()
+            ? std::string_view(accept_encoding->second)
+            : std::string_view())));
+  }
+
+  return key;
+}
+
+std::shared_ptr<const CachedResponse>
+Weblet::cache_entry(const CachePolicy &policy, const Response &response) {
+  if (response.status_code != 200 || response.file || response.streamed() ||
+      !response.cookies.empty())
+    return nullptr;
+
+  long long max_age = policy.max_age, shared_max_age = -1,
+            stale = policy.stale_while_revalidate;
+
+  for (const auto &header : response.headers) {
+    if (iequals(header.first, "Connection"))
+      return nullptr;
+    else if (!iequals(header.first, "Cache-Control"))
+      continue;
+
+    std::string_view directives(header.second);
+    while (!directives.empty()) {
+      size_t separator = directives.find(',');
+      std::string_view directive = directives.substr(0, separator);
+
+      directives = separator == std::string_view::npos
+                       ? std::string_view()
+                       : directives.substr(separator + 1);
+
+      while (!directive.empty() && directive.front() == ' ')
+        directive.remove_prefix(1);
+
+      size_t equals = directive.find('=');
+      std::string_view name = directive.substr(0, equals);
+      long long seconds = -1;
+
+      if (equals != std::string_view::npos)
+        std::from_chars(directive.data() + equals + 1,
+                        directive.data() + directive.size(), seconds);
+
+      if (iequals(name, "no-store") || iequals(name, "no-cache") ||
+          iequals(name, "private"))
+        return nullptr;
+      else if (iequals(name, "max-age") && seconds >= 0)
+        max_age = seconds;
+      else if (iequals(name, "s-maxage") && seconds >= 0)
+        shared_max_age = seconds;
+      else if (iequals(name, "stale-while-revalidate") && seconds >= 0)
+        stale = seconds;
+    }
+  }
+
+  if (shared_max_age >= 0)
+    max_age = shared_max_age;
+
+  if (max_age <= 0)
+    return nullptr;
+
+  long long now = monotonic_ms();
+  std::string head = this->build_response_head(response);
+  head.resize(head.size() - 2);
+
+  return std::make_shared<const CachedResponse>(
+      CachedResponse{std::move(head), response.contents, now,
+                     now + max_age * 1000, now + (max_age + stale) * 1000});
+}
+
+Response Weblet::cached_response(const CachedResponse &entry) {
+  Response response;
+  std::string_view head(entry.head);
+  size_t line_end = head.find("\r\n");
+  std::string_view status = head.substr(0, line_end);
+  size_t separator = status.find(' ', status.find(' ') + 1);
+
+  if (separator != std::string_view::npos)
+    response.status_message = status.substr(separator + 1);
+
+  while (line_end != std::string_view::npos) {
+    head.remove_prefix(line_end + 2);
+    line_end = head.find("\r\n");
+
+    std::string_view line = head.substr(0, line_end);
+    size_t colon = line.find(": ");
+
+    if (colon != std::string_view::npos &&
+        !iequals(line.substr(0, colon), "Content-Length"))
+      response.headers.emplace(line.substr(0, colon),
+                               line.substr(colon + 2));
+  }
+
+  response.contents = entry.body;
+  response.compress = false;
+  response.set_header(
+      "Age", std::to_string((monotonic_ms() - entry.stored_at) / 1000));
+
+  return response;
+}
+
+std::string Weblet::cached_head(const CachedResponse &entry, bool keep_alive,
+                                const std::string &version) {
+  std::string head = entry.head;
+
+  head.append("Age: ")
+      .append(std::to_string((monotonic_ms() - entry.stored_at) / 1000))
+      .append("\r\nConnection: ")
+      .append(keep_alive ? "keep-alive" : "close")
+      .append("\r\n");
+
+  if (keep_alive && version == "HTTP/1.0")
+    head.append("Keep-Alive: timeout=")
+        .append(std::to_string(this->keep_alive_timeout))
+        .append("\r\n");
+
+  return head.append("\r\n");
+}
+
+bool Weblet::limit_request(Connection &connection, const Request &request,
+                           bool keep_alive) {
+  std::string key = this->rate_limit_key ? this->rate_limit_key(request) : "";
+  long long retry_after = 0;
+
+  if (this->rate_limiter->allow(key.empty() ? "ip:" + request.remote_address
+                                            : "key:" + key,
+                                retry_after))
+    return false;
+
+  Response response = this->handle_error(429, "Rate limit exceeded.");
+  response.set_header(
+      "Retry-After", std::to_string(std::max(1LL, (retry_after + 999) / 1000)));
+  response.set_header("Connection", keep_alive ? "keep-alive" : "close");
+
+  PendingResponse &slot = connection.pending.back();
+  slot.ready = true;
+  slot.head = this->build_response_head(response);
+  slot.body = std::move(response.contents);
+
+  this->limited_requests++;
+  return true;
+}
+
+void Weblet::reject_request(Connection &connection) {
+  PendingResponse &slot = connection.pending.back();
+
+  slot.ready = true;
+  slot.keep_alive = false;
+  slot.head = this->overload_response;
+  connection.close_after_write = true;
+
+  this->rejected_requests++;
+}
+
+bool Weblet::upgrade_websocket(EventLoop &loop, Connection &connection,
+                               Request &request) {
+  RouteMatch match;
+  if (!this->router.match(request.request_path, match) ||
+      !this->routes[match.route].websocket)
+    return false;
+
+  auto header = [&request](const char *name) {
+    auto found = request.headers.find(name);
+    return found != request.headers.end() ? std::string_view(found->second)
+                                          : std::string_view();
+  };
+
+  std::string_view key = header("Sec-WebSocket-Key");
+  Response response;
+
+  if (request.method != "GET" || request.version != "HTTP/1.1" ||
+      !has_token(header("Upgrade"), "websocket") ||
+      !has_token(header("Connection"), "upgrade") ||
+      header("Sec-WebSocket-Version") != "13") {
+    response = this->handle_error(426, "Upgrade Required.");
+    response.set_header("Upgrade", "websocket");
+    response.set_header("Sec-WebSocket-Version", "13");
+  } else if (key.size() != 24)
+    response =
+        this->handle_error(400, "Bad Request: Invalid Sec-WebSocket-Key.");
+  else if (connection.pending.size() != 1 || connection.output_file ||
+           connection.output_stream)
+    response = this->handle_error(
+        400, "Bad Request: Upgrade requested behind pipelined requests.");
+  else {
+    std::shared_ptr<const WebSocketHandler> handler =
+        this->routes[match.route].websocket;
+    std::shared_ptr<WebSocket> socket = std::make_shared<WebSocket>(
+        &loop, connection.id, connection.fd, connection.peer_address());
+
+    connection.pending.pop_back();
+    connection.first_sequence++;
+    connection.close_after_write = false;
+    connection.output.push_back(
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " +
+        websocket_accept_key(key) + "\r\n\r\n");
+
+    connection.websocket = std::make_unique<WebSocketSession>(socket);
+    connection.websocket->on_message = [this, socket,
+                                        handler](std::string message,
+                                                 bool binary) {
+      if (!handler->on_message)
+        return;
+
+      socket->dispatch(this->tasklet_manager, [this, socket, handler,
+                                               message = std::move(message),
+                                               binary] {
+        try {
+          handler->on_message(socket, message, binary);
+        } catch (const std::exception &e) {
+          this->handler_exception("WebSocket handler failed: " +
+                                  std::string(e.what()));
+        }
+      });
+    };
+    connection.websocket->on_close = [this, socket, handler](uint16_t code) {
+      if (!handler->on_close)
+        return;
+
+      socket->dispatch(this->tasklet_manager, [this, socket, handler, code] {
+        try {
+          handler->on_close(socket, code);
+        } catch (const std::exception &e) {
+          this->handler_exception("WebSocket handler failed: " +
+                                  std::string(e.what()));
+        }
+      });
+    };
 
-      response =
-          this->handle_error(400, "Bad Request: Incomplete request body.");
+    if (handler->on_open)
+      socket->dispatch(this->tasklet_manager, [this, socket, handler,
+                                               request = std::move(request)] {
+        RouteMatch route_match;
+        this->router.match(request.request_path, route_match);
+
+        std::shared_ptr<const Purple::Format::DotEnv> config =
+            this->config_snapshot();
+        RouteParams params(this->routes[route_match.route].path_names,
+                           route_match);
+
+        try {
+          handler->on_open(socket, {request, params, *config});
+        } catch (const std::exception &e) {
+          this->handler_exception("WebSocket handler failed: " +
+                                  std::string(e.what()));
+        }
+      });
 
-      this->safe_send(client_socket_fd, this->build_response_str(response));
-      return;
+    return true;
+  }
+
+  response.set_header("Connection", "close");
+
+  PendingResponse &slot = connection.pending.back();
+  slot.ready = true;
+  slot.keep_alive = false;
+  slot.head = this->build_response_head(response);
+  slot.body = std::move(response.contents);
+  connection.close_after_write = true;
+
+  return true;
+}
+
+void Weblet::receive_frames(Connection &connection) {
+  WebSocketSession &session = *connection.websocket;
+  size_t offset = 0;
+
+  while (!connection.close_after_write) {
+    WebSocketFrame frame{};
+    WebSocketParseStatus status = parse_websocket_frame(
+        connection.input, offset, this->websocket_max_message, frame);
+
+    if (status == WebSocketParseStatus::Incomplete)
+      break;
+    else if (status == WebSocketParseStatus::Error) {
+      this->close_websocket(connection, frame.close_code);
+      break;
     }
 
-    request_body_str.append(raw_request_bytes.data() + total_received_bytes,
-                            read_result);
+    offset += frame.length;
+    if (session.close_sent && frame.opcode != WebSocketOpcode::Close)
+      continue;
+    else if (frame.opcode == WebSocketOpcode::Ping)
+      connection.output.push_back(
+          encode_websocket_frame(WebSocketOpcode::Pong, frame.payload));
+    else if (frame.opcode == WebSocketOpcode::Close) {
+      if (frame.payload.size() == 1) {
+        this->close_websocket(connection, 1002);
+        break;
+      }
+
+      session.close_code =
+          frame.payload.size() < 2
+              ? 1005
+              : static_cast<uint16_t>(
+                    static_cast<unsigned char>(frame.payload[0]) << 8 |
+                    static_cast<unsigned char>(frame.payload[1]));
+      this->close_websocket(connection, session.close_code);
+    } else if (frame.opcode != WebSocketOpcode::Pong) {
+      bool continuation = frame.opcode == WebSocketOpcode::Continuation;
+
+      if (continuation != session.fragmented) {
+        this->close_websocket(connection, 1002);
+        break;
+      } else if (session.message.size() + frame.payload.size() >
+                 this->websocket_max_message) {
+        this->close_websocket(connection, 1009);
+        break;
+      }
+
+      if (!continuation)
+        session.message_opcode = frame.opcode;
+
+      if (frame.fin && !continuation)
+        session.message.assign(frame.payload);
+      else
+        session.message.append(frame.payload);
+
+      session.fragmented = !frame.fin;
+      if (session.fragmented)
+        continue;
+
+      bool binary = session.message_opcode == WebSocketOpcode::Binary;
+      if (!binary && !is_valid_utf8(session.message)) {
+        this->close_websocket(connection, 1007);
+        break;
+      }
+
+      session.on_message(std::move(session.message), binary);
+      session.message.clear();
+    }
   }
 
-  if (request.headers.count("Content-Type")) {
-    std::string content_type = request.headers["Content-Type"];
+  if (connection.close_after_write)
+    connection.input.clear();
+  else
+    connection.input.erase(0, offset);
+}
+
+void Weblet::close_websocket(Connection &connection, uint16_t code) {
+  if (!connection.websocket->close_sent)
+    connection.output.push_back(encode_websocket_close(code, ""));
 
-    if (content_type.rfind("multipart/form-data", 0) == 0) {
-      std::smatch match;
-      std::regex boundary_regex("boundary=([^;]+)");
+  connection.websocket->close_sent = true;
+  connection.close_after_write = true;
+}
 
-      if (std::regex_search(content_type, match, boundary_regex)) {
-        std::string boundary = match[1].str();
-        this->parse_multipart_data(request_body_str, boundary, request);
-      } else {
-        this->handler_exception("Multipart form-data without boundary");
-        response = this->handle_error(
-            400,
-            "Bad Request: Malformed multipart/form-data (missing boundary).");
+void Weblet::release_websocket(Connection &connection) {
+  if (!connection.websocket)
+    return;
 
-        this->safe_send(client_socket_fd, this->build_response_str(response));
-        return;
+  std::unique_ptr<WebSocketSession> session = std::move(connection.websocket);
+  session->socket->detach();
+  session->on_close(session->close_code);
+}
+
+void Weblet::deliver_frames(EventLoop &loop) {
+  std::vector<std::pair<int, uint64_t>> touched;
+
+  for (FrameDelivery &delivery : loop.take_frames())
+    for (const auto &[fd, id] : delivery.targets) {
+      auto found = loop.connections.find(fd);
+
+      if (found == loop.connections.end() || found->second->id != id ||
+          found->second->closing)
+        continue;
+
+      Connection &connection = *found->second;
+      size_t backlog_limit = WEBLET_WEBSOCKET_MAX_QUEUED_FRAMES;
+
+      if (connection.event_stream)
+        backlog_limit = connection.event_stream->max_backlog();
+      else if (!connection.websocket || connection.websocket->close_sent)
+        continue;
+
+      if (connection.output.size() >= backlog_limit) {
+        if (!connection.event_stream ||
+            connection.event_stream->overflow_policy() ==
+                SseOverflow::Disconnect)
+          this->close_connection(loop, fd);
+
+        continue;
       }
-    } else if (content_type.rfind("application/x-www-form-urlencoded", 0) ==
-               0) {
-      request.contents = request_body_str;
-      this->parse_url_enc_data(request_body_str, request);
-    } else
-      request.contents = request_body_str;
-  } else
-    request.contents = request_body_str;
 
-  this->safe_send(client_socket_fd,
-                  this->build_response_str(this->route_request(request)));
+      connection.output.push_back(delivery.frame);
+      if (delivery.closing)
+        connection.websocket->close_sent = true;
+
+      touched.push_back({fd, id});
+    }
+
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+  for (const auto &[fd, id] : touched) {
+    auto found = loop.connections.find(fd);
+    if (found == loop.connections.end() || found->second->id != id ||
+        found->second->closing)
+      continue;
+
+    if (!this->flush_connection(loop, *found->second))
+      this->close_connection(loop, fd);
+    else
+      this->arm_timeout(loop, *found->second);
+  }
+}
+
+bool Weblet::subscribe_events(EventLoop &loop, Connection &connection,
+                              Request &request) {
+  RouteMatch match;
+  if (!this->router.match(request.request_path, match) ||
+      !this->routes[match.route].events)
+    return false;
+
+  Response response;
+  if (request.method != "GET") {
+    response = this->handle_error(405, "Method Not Allowed.");
+    response.set_header("Allow", "GET");
+  } else if (connection.pending.size() != 1 || connection.output_file ||
+             connection.output_stream)
+    response = this->handle_error(
+        400, "Bad Request: Event stream requested behind pipelined requests.");
+  else {
+    std::shared_ptr<SsePublisher> publisher = this->routes[match.route].events;
+    uint64_t last_event_id = 0;
+    auto header = request.headers.find("Last-Event-ID");
+
+    if (header != request.headers.end())
+      std::from_chars(header->second.data(),
+                      header->second.data() + header->second.size(),
+                      last_event_id);
+
+    connection.pending.pop_back();
+    connection.first_sequence++;
+    connection.close_after_write = false;
+    connection.output.push_back(
+        std::string("HTTP/1.1 200 OK\r\n"
+                    "Content-Type: text/event-stream\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "Connection: close\r\n\r\n"));
+
+    for (std::shared_ptr<const std::string> &event :
+         publisher->subscribe(&loop, connection.id, connection.fd,
+                              last_event_id))
+      connection.output.push_back(std::move(event));
+
+    connection.event_stream = std::move(publisher);
+    return true;
+  }
+
+  response.set_header("Connection", "close");
+
+  PendingResponse &slot = connection.pending.back();
+  slot.ready = true;
+  slot.keep_alive = false;
+  slot.head = this->build_response_head(response);
+  slot.body = std::move(response.contents);
+  connection.close_after_write = true;
+
+  return true;
+}
+
+void Weblet::release_event_stream(EventLoop &loop, Connection &connection) {
+  if (!connection.event_stream)
+    return;
+
+  connection.event_stream->unsubscribe(&loop, connection.id);
+  connection.event_stream.reset();
+}
+
+bool Weblet::wants_keep_alive(const Request &request) const {
+  if (this->keep_alive_timeout <= 0)
+    return false;
+
+  auto connection_header = request.headers.find("Connection");
+  if (request.version == "HTTP/1.0")
+    return connection_header != request.headers.end() &&
+           strcasecmp(connection_header->second.c_str(), "keep-alive") == 0;
+
+  return connection_header == request.headers.end() ||
+         strcasecmp(connection_header->second.c_str(), "close") != 0;
 }
 
-Response Weblet::route_request(const Request &request) {
-  for (const Purple::Net::Route &route : this->routes) {
-    std::smatch match;
+void Weblet::parse_cookies(std::string_view header, Request &request) {
+  auto trim = [](std::string_view text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string_view::npos)
+      return std::string_view();
+
+    return text.substr(start, text.find_last_not_of(" \t") - start + 1);
+  };
 
-    if (std::regex_match(request.request_path, match, route.path_regex)) {
-      std::map<std::string, std::string> parameters;
+  while (!header.empty()) {
+    size_t separator = header.find(';');
+    std::string_view cookie_pair = header.substr(0, separator);
 
-      for (size_t i = 0; i < route.path_names.size(); ++i) {
-        if (i + 1 < match.size()) {
-          std::string paramValue = match[i + 1].str();
+    header = separator == std::string_view::npos
+                 ? std::string_view()
+                 : header.substr(separator + 1);
 
-          if (paramValue != "")
-            parameters[route.path_names[i]] = paramValue;
+    size_t eq_pos = cookie_pair.find('=');
+    if (eq_pos != std::string_view::npos)
+      request.cookies[std::string(trim(cookie_pair.substr(0, eq_pos)))] =
+          std::string(trim(cookie_pair.substr(eq_pos + 1)));
+  }
+}
+
+void Weblet::parse_url_enc_data(const std::string &body, Request &request) {
+  std::istringstream form_data_stream(body);
+  std::string pair;
+
+  auto url_decode =
+      [exception_fn = this->handler_exception](const std::string &encoded_str) {
+        std::string decoded_str;
+        for (size_t i = 0; i < encoded_str.length(); ++i) {
+          if (encoded_str[i] == '+')
+            decoded_str += ' ';
+          else if (encoded_str[i] == '%' && i + 2 < encoded_str.length()) {
+            try {
+              decoded_str += static_cast<char>(
+                  std::stoi(encoded_str.substr(i + 1, 2), nullptr, 16));
+              i += 2;
+            } catch (const std::exception &e) {
+              exception_fn("Malformed URL encoding encountered: " +
+                           encoded_str.substr(i, 3));
+              decoded_str += encoded_str[i];
+            }
+          } else
+            decoded_str += encoded_str[i];
         }
+
+        return decoded_str;
+      };
+
+  while (std::getline(form_data_stream, pair, '&')) {
+    size_t eq_pos = pair.find('=');
+    if (eq_pos != std::string::npos) {
+      std::string key = pair.substr(0, eq_pos);
+      std::string value = pair.substr(eq_pos + 1);
+
+      request.form_fields[url_decode(key)] = url_decode(value);
+    }
+  }
+}
+
+std::string Weblet::build_response_head(const Response &response) {
+  std::string head;
+  head.reserve(128 + response.headers.size() * 48 +
+               response.cookies.size() * 64);
+
+  head.append("HTTP/1.1 ")
+      .append(std::to_string(response.status_code))
+      .append(" ")
+      .append(response.status_message)
+      .append("\r\n");
+
+  if (response.status_code >= 200 && response.status_code != 204 &&
+      response.status_code != 304 && !response.streamed())
+    head.append("Content-Length: ")
+        .append(std::to_string(response.file ? response.file->body_length()
+                                             : response.contents.length()))
+        .append("\r\n");
+
+  for (const auto &header : response.headers)
+    head.append(header.first)
+        .append(": ")
+        .append(header.second)
+        .append("\r\n");
+
+  for (const auto &cookie : response.cookies)
+    head.append("Set-Cookie: ").append(cookie.second).append("\r\n");
+
+  return head.append("\r\n");
+}
+
+void Weblet::build_request(const HttpRequestHead &head, Request &request) {
+  request.method = head.method;
+  request.full_url = head.target;
+  request.request_path = head.path;
+  request.query = head.query;
+  request.version = head.version;
+
+  for (size_t i = 0; i < head.header_count; i++) {
+    const HttpHeader &header = head.headers[i];
+    auto [field, inserted] = request.headers.emplace(header.name, header.value);
+
+    if (!inserted)
+      field->second = header.value;
+
+    if (iequals(header.name, "Cookie"))
+      this->parse_cookies(header.value, request);
+  }
+}
+
+void Weblet::parse_request_body(Request &request) {
+  auto content_type = request.headers.find("Content-Type");
+
+  if (!request.spooled_body && content_type != request.headers.end() &&
+      content_type->second.rfind("application/x-www-form-urlencoded", 0) == 0)
+    this->parse_url_enc_data(request.contents, request);
+}
+
+void Weblet::build_middleware() {
+  std::vector<MiddlewareChain> chains(this->routes.size(),
+                                      this->global_middleware);
+
+  for (const auto &[pattern, middleware] : this->route_middleware) {
+    auto route = std::find_if(
+        this->routes.begin(), this->routes.end(),
+        [&pattern = pattern](const Route &candidate) {
+          return candidate.pattern == pattern;
+        });
+
+    if (route == this->routes.end()) {
+      this->handler_exception("Middleware registered for unknown route: " +
+                              pattern);
+      continue;
+    }
+
+    chains[route - this->routes.begin()].push_back(middleware);
+  }
+
+  for (size_t index = 0; index < this->routes.size(); index++)
+    this->routes[index].middleware =
+        chains[index].empty()
+            ? nullptr
+            : std::make_shared<const MiddlewareChain>(std::move(chains[index]));
+}
+
+bool Weblet::enter_middleware(const MiddlewareChain *chain,
+                              const RequestContext &context,
+                              Response &response, size_t &entered) {
+  entered = 0;
+  if (!chain)
+    return true;
+
+  try {
+    for (; entered < chain->size(); entered++) {
+      const Middleware &middleware = (*chain)[entered];
+
+      if (middleware.before && !middleware.before(context, response)) {
+        entered++;
+        return false;
       }
+    }
+  } catch (const std::exception &e) {
+    this->handler_exception("Middleware failed: " + std::string(e.what()));
+    response = this->handle_error(500, "Request handler failed.");
+    return false;
+  }
+
+  return true;
+}
+
+void Weblet::leave_middleware(const MiddlewareChain *chain, size_t entered,
+                              const RequestContext &context,
+                              Response &response) {
+  try {
+    while (entered > 0) {
+      const Middleware &middleware = (*chain)[--entered];
+
+      if (middleware.after)
+        middleware.after(context, response);
+    }
+  } catch (const std::exception &e) {
+    this->handler_exception("Middleware failed: " + std::string(e.what()));
+    response = this->handle_error(500, "Request handler failed.");
+  }
+}
+
+size_t Weblet::trace_head(Connection &connection, const Request &request,
+                          long long parse_started) {
+  long long parsed = monotonic_ns();
+  RouteMatch match;
+  size_t route = this->router.match(request.request_path, match)
+                     ? match.route
+                     : this->routes.size();
+  long long matched = monotonic_ns();
+
+  this->metrics->record(route, RequestPhase::HeaderRead,
+                        parse_started - connection.trace.head_started);
+  this->metrics->record(route, RequestPhase::Parse, parsed - parse_started);
+  this->metrics->record(route, RequestPhase::RouteMatch, matched - parsed);
+  connection.trace.head_started = 0;
+
+  return route;
+}
 
-      return route.handler(this->configuration, request, parameters);
+Response Weblet::route_request(const Request &request, size_t &route_slot) {
+  static const std::vector<std::string> no_path_names;
+  RouteMatch match;
+  const Route *route = this->router.match(request.request_path, match)
+                           ? &this->routes[match.route]
+                           : nullptr;
+
+  if (route)
+    route_slot = match.route;
+  const MiddlewareChain *chain =
+      route ? route->middleware.get()
+      : this->global_middleware.empty() ? nullptr
+                                        : &this->global_middleware;
+
+  if (!route && !chain)
+    return this->serve_public(request);
+
+  std::shared_ptr<const Purple::Format::DotEnv> config =
+      this->config_snapshot();
+  RouteParams params(route ? route->path_names : no_path_names, match);
+  RequestContext context{request, params, *config};
+
+  if (!chain)
+    return route->handler(context);
+
+  Response response;
+  size_t entered = 0;
+
+  if (this->enter_middleware(chain, context, response, entered)) {
+    try {
+      response = route ? route->handler(context) : this->serve_public(request);
+    } catch (const std::exception &e) {
+      this->handler_exception("Request handler failed: " +
+                              std::string(e.what()));
+      response = this->handle_error(500, "Request handler failed.");
     }
   }
 
-  if (!this->public_dir.empty()) {
+  this->leave_middleware(chain, entered, context, response);
+  return response;
+}
+
+Response Weblet::serve_public(const Request &request) {
+  if (this->static_cache) {
     std::string requested_path = request.request_path;
     if (requested_path == "/" || requested_path.empty())
       requested_path = "/index.html";
 
-    std::string filepath = this->public_dir + requested_path;
-    if (std::filesystem::exists(filepath) &&
-        std::filesystem::is_regular_file(filepath))
-      return this->serve_static(filepath);
+    if (requested_path.find("..") != std::string::npos)
+      return this->handle_error(404);
+
+    std::shared_ptr<const StaticAsset> asset =
+        this->static_cache->find(requested_path);
+
+    if (asset)
+      return this->serve_asset(request, *asset);
     else if (this->spa) {
       std::string filename_part;
       size_t last_slash = requested_path.rfind('/');
@@ -675,46 +3100,193 @@ Response Weblet::route_request(const Request &request) {
       else
         filename_part = requested_path;
 
-      std::string spa_index_path = this->public_dir + "/index.html";
       bool is_asset_request = (filename_part.find('.') != std::string::npos);
-
-      if (!is_asset_request && std::filesystem::exists(spa_index_path) &&
-          std::filesystem::is_regular_file(spa_index_path))
-        return this->serve_static(spa_index_path);
+      if (!is_asset_request &&
+          (asset = this->static_cache->find("/index.html")))
+        return this->serve_asset(request, *asset);
     }
   }
 
   return this->handle_error(404);
 }
 
-Response Weblet::serve_static(const std::string &filepath) {
+Response Weblet::serve_asset(const Request &request,
+                             const StaticAsset &asset) {
   Response response;
-  std::ifstream file(filepath, std::ios::binary);
+  const StaticAsset *variant = &asset;
 
-  if (file.is_open()) {
-    std::string content((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
+  auto range = request.headers.find("Range");
+  bool ranged = range != request.headers.end() && request.method == "GET" &&
+                this->if_range_matches(request, asset);
+
+  if (asset.gzip) {
+    auto accept_encoding = request.headers.find("Accept-Encoding");
+
+    response.set_header("Vary", "Accept-Encoding");
+    if (!ranged && accept_encoding != request.headers.end() &&
+        negotiate_coding(accept_encoding->second) == ContentCoding::Gzip) {
+      variant = asset.gzip.get();
+      response.set_header("Content-Encoding", "gzip");
+    }
+  }
+
+  response.set_header("ETag", variant->etag);
+  response.set_header("Last-Modified", asset.last_modified);
+
+  if (this->is_not_modified(request, *variant)) {
+    response.status_code = 304;
+    response.status_message = "Not Modified";
+    response.headers.erase("Content-Encoding");
+
+    return response;
+  }
 
-    response.contents = content;
-    response.status_code = 200;
-    response.status_message = "OK";
+  response.status_code = 200;
+  response.status_message = "OK";
+  response.set_header("Content-Type", asset.content_type);
+  response.set_header("Accept-Ranges", "bytes");
+  response.compress = false;
+
+  std::vector<std::pair<size_t, size_t>> ranges;
+  RangeParse status =
+      ranged ? parse_byte_ranges(range->second, asset.size, ranges)
+             : RangeInvalid;
+
+  if (status == RangeUnsatisfiable) {
+    response.status_code = 416;
+    response.status_message = "Range Not Satisfiable";
+    response.set_header("Content-Range",
+                        "bytes */" + std::to_string(asset.size));
+
+    return response;
+  } else if (status == RangeSatisfiable) {
+    this->serve_ranges(asset, ranges, response);
+    return response;
+  }
 
-    response.set_header("Content-Type", get_mime_type(filepath));
-  } else
-    return this->handle_error(500, "Could not read file: " + filepath);
+  if (!variant->contents ||
+      (variant->file && variant->size > this->sendfile_threshold))
+    response.file = variant->file;
+  else
+    response.contents.assign(variant->contents, variant->size);
 
   return response;
 }
 
+void Weblet::serve_ranges(
+    const StaticAsset &asset,
+    const std::vector<std::pair<size_t, size_t>> &ranges,
+    Response &response) {
+  bool in_memory = asset.contents && asset.size <= this->sendfile_threshold;
+  std::string total = "/" + std::to_string(asset.size);
+
+  response.status_code = 206;
+  response.status_message = "Partial Content";
+
+  if (ranges.size() == 1) {
+    auto [first, last] = ranges.front();
+    response.set_header("Content-Range", "bytes " + std::to_string(first) +
+                                             "-" + std::to_string(last) +
+                                             total);
+
+    if (in_memory)
+      response.contents.assign(asset.contents + first, last - first + 1);
+    else
+      response.file = std::make_shared<ResponseFile>(
+          asset.file, static_cast<off_t>(first), last - first + 1);
+
+    return;
+  }
+
+  thread_local std::mt19937_64 generator(std::random_device{}());
+  char boundary[32];
+  snprintf(boundary, sizeof(boundary), "%016llx",
+           static_cast<unsigned long long>(generator()));
+
+  response.set_header("Content-Type",
+                      "multipart/byteranges; boundary=" +
+                          std::string(boundary));
+
+  std::shared_ptr<ResponseFile> *tail = &response.file;
+  for (const auto &[first, last] : ranges) {
+    std::string part = "\r\n--" + std::string(boundary) +
+                       "\r\nContent-Type: " + asset.content_type +
+                       "\r\nContent-Range: bytes " + std::to_string(first) +
+                       "-" + std::to_string(last) + total + "\r\n\r\n";
+
+    if (in_memory) {
+      response.contents.append(part).append(asset.contents + first,
+                                            last - first + 1);
+      continue;
+    }
+
+    *tail = std::make_shared<ResponseFile>(
+        asset.file, static_cast<off_t>(first), last - first + 1);
+    (*tail)->prefix = std::move(part);
+    tail = &(*tail)->next;
+  }
+
+  std::string closing = "\r\n--" + std::string(boundary) + "--\r\n";
+  if (in_memory)
+    response.contents.append(closing);
+  else {
+    *tail = std::make_shared<ResponseFile>(asset.file, 0, 0);
+    (*tail)->prefix = std::move(closing);
+  }
+}
+
+bool Weblet::if_range_matches(const Request &request,
+                              const StaticAsset &asset) {
+  auto if_range = request.headers.find("If-Range");
+  if (if_range == request.headers.end())
+    return true;
+
+  std::string_view validator = if_range->second;
+  std::time_t date;
+
+  if (!validator.empty() && validator.front() == '"')
+    return validator == asset.etag;
+
+  return validator.rfind("W/", 0) != 0 &&
+         parse_http_date(validator, date) && date == asset.modified_time;
+}
+
+bool Weblet::is_not_modified(const Request &request,
+                             const StaticAsset &asset) {
+  if (request.method != "GET" && request.method != "HEAD")
+    return false;
+
+  auto if_none_match = request.headers.find("If-None-Match");
+  if (if_none_match != request.headers.end()) {
+    std::istringstream tags(if_none_match->second);
+    std::string tag;
+
+    while (std::getline(tags, tag, ',')) {
+      tag.erase(0, tag.find_first_not_of(" \t"));
+      tag.erase(tag.find_last_not_of(" \t") + 1);
+
+      if (tag.rfind("W/", 0) == 0)
+        tag.erase(0, 2);
+
+      if (tag == "*" || tag == asset.etag)
+        return true;
+    }
+
+    return false;
+  }
+
+  auto if_modified_since = request.headers.find("If-Modified-Since");
+  std::time_t since;
+
+  return if_modified_since != request.headers.end() &&
+         parse_http_date(if_modified_since->second, since) &&
+         asset.modified_time <= since;
+}
+
 Response Weblet::handle_error(int error_code, const std::string &message) {
   Response response;
   response.status_code = error_code;
-  response.status_message = "Not Found";
-
-  if (error_code == 404)
-    response.status_message = "Not Found";
-  else if (error_code == 500)
-    response.status_message = "Internal Server Error";
+  response.status_message = status_text(error_code);
 
   if (this->error_handlers.count(error_code)) {
     std::string errorfilepath = this->error_handlers[error_code];
@@ -750,11 +3322,144 @@ Response Weblet::handle_error(int error_code, const std::string &message) {
 bool Weblet::is_spa() const { return this->spa; }
 
 void Weblet::set_config(Purple::Format::DotEnv config) {
-  this->configuration = config;
+  auto snapshot =
+      std::make_shared<const Purple::Format::DotEnv>(std::move(config));
+
+  std::lock_guard<std::mutex> lock(this->config_mutex);
+  this->configuration = std::move(snapshot);
 }
 
 Purple::Format::DotEnv Weblet::get_config() const {
+  return *this->config_snapshot();
+}
+
+std::shared_ptr<const Purple::Format::DotEnv> Weblet::config_snapshot() const {
+  std::lock_guard<std::mutex> lock(this->config_mutex);
   return this->configuration;
 }
 
+void Weblet::set_keep_alive_timeout(int seconds) {
+  this->keep_alive_timeout = seconds;
+}
+
+void Weblet::set_header_timeout(int seconds) {
+  this->header_timeout = seconds;
+}
+
+void Weblet::set_body_timeout(int seconds) { this->body_timeout = seconds; }
+
+void Weblet::set_write_timeout(int seconds) { this->write_timeout = seconds; }
+
+void Weblet::set_max_connections(size_t count) {
+  this->max_connections = count;
+}
+
+void Weblet::set_max_inflight_requests(size_t count) {
+  this->max_inflight_requests = count;
+}
+
+void Weblet::set_max_queued_tasks(size_t count) {
+  this->max_queued_tasks = count;
+}
+
+void Weblet::set_retry_after(int seconds) { this->retry_after = seconds; }
+
+void Weblet::set_response_cache_limits(size_t bytes, size_t items) {
+  this->response_cache_size = bytes;
+  this->response_cache_items = items;
+}
+
+void Weblet::set_rate_limit(double rate, size_t burst, RateLimitKey key) {
+  this->rate_limiter = std::make_unique<RateLimiter>(rate, burst);
+  this->rate_limit_key = std::move(key);
+}
+
+WebletLoadStats Weblet::load_stats() {
+  return {this->open_connections, this->inflight_requests,
+          this->tasklet_manager.queued_tasks(), this->rejected_connections,
+          this->rejected_requests, this->limited_requests};
+}
+
+void Weblet::enable_metrics(const std::string &path) {
+  this->metrics_enabled = true;
+  if (path.empty())
+    return;
+
+  this->handle(path, [this](const RequestContext &) {
+    Response response;
+    response.set_header("Content-Type",
+                        "text/plain; version=0.0.4; charset=utf-8");
+    response.contents = this->render_metrics();
+
+    return response;
+  });
+}
+
+std::string Weblet::render_metrics() {
+  WebletLoadStats stats = this->load_stats();
+  std::string text = this->metrics ? this->metrics->render() : std::string();
+
+  for (const auto &[name, type, value] :
+       {std::make_tuple("weblet_open_connections", "gauge",
+                        static_cast<uint64_t>(stats.open_connections)),
+        std::make_tuple("weblet_inflight_requests", "gauge",
+                        static_cast<uint64_t>(stats.inflight_requests)),
+        std::make_tuple("weblet_queued_tasks", "gauge",
+                        static_cast<uint64_t>(stats.queued_tasks)),
+        std::make_tuple("weblet_rejected_connections_total", "counter",
+                        stats.rejected_connections),
+        std::make_tuple("weblet_rejected_requests_total", "counter",
+                        stats.rejected_requests),
+        std::make_tuple("weblet_limited_requests_total", "counter",
+                        stats.limited_requests)})
+    text.append("# TYPE ")
+        .append(name)
+        .append(" ")
+        .append(type)
+        .append("\n")
+        .append(name)
+        .append(" ")
+        .append(std::to_string(value))
+        .append("\n");
+
+  return text;
+}
+
+void Weblet::set_websocket_max_message(size_t bytes) {
+  this->websocket_max_message = bytes;
+}
+
+void Weblet::set_compression(size_t min_size, int level) {
+  this->compression_enabled = true;
+  this->compression_min_size = min_size;
+  this->compression_level = level;
+}
+
+void Weblet::set_sendfile_threshold(size_t bytes) {
+  this->sendfile_threshold = bytes;
+}
+
+void Weblet::set_event_loops(size_t count) { this->event_loop_count = count; }
+
+void Weblet::set_io_uring(bool enabled) { this->io_uring_enabled = enabled; }
+
+void Weblet::set_body_spool_threshold(size_t bytes) {
+  this->body_spool_threshold = bytes;
+}
+
+void Weblet::set_max_body_size(size_t bytes) { this->max_body_size = bytes; }
+
+void Weblet::set_upload_directory(const std::string &directory) {
+  this->upload_directory = directory;
+}
+
+void Weblet::set_upload_sink(UploadSinkFactory factory) {
+  this->upload_sink = std::move(factory);
+}
+
+std::string Weblet::default_upload_directory() {
+  const char *directory = std::getenv("TMPDIR");
+  return directory && *directory ? directory : "/tmp";
+}
+
 } // namespace Purple::Net
@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) 2025 - Nathanne Isip
+ * This file is part of Purple.
+ *
+ * Purple is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * Purple is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Purple. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <purple/net/event_loop.hpp>
+#include <purple/net/websocket.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Purple::Net {
+
+static const char *websocket_guid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static std::array<unsigned char, 20> sha1(std::string_view data) {
+  uint32_t state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                       0xC3D2E1F0};
+  std::string message(data);
+  uint64_t bit_length = static_cast<uint64_t>(data.size()) * 8;
+
+  message.push_back(static_cast<char>(0x80));
+  while (message.size() % 64 != 56)
+    message.push_back('\0');
+
+  for (int shift = 56; shift >= 0; shift -= 8)
+    message.push_back(static_cast<char>((bit_length >> shift) & 0xff));
+
+  auto rotate = [](uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+  };
+
+  for (size_t block = 0; block < message.size(); block += 64) {
+    uint32_t words[80];
+
+    for (int i = 0; i < 16; i++)
+      words[i] =
+          static_cast<uint32_t>(
+              static_cast<unsigned char>(message[block + i * 4])) << 24 |
+          static_cast<uint32_t>(
+              static_cast<unsigned char>(message[block + i * 4 + 1])) << 16 |
+          static_cast<uint32_t>(
+              static_cast<unsigned char>(message[block + i * 4 + 2])) << 8 |
+          static_cast<uint32_t>(
+              static_cast<unsigned char>(message[block + i * 4 + 3]));
+
+    for (int i = 16; i < 80; i++)
+      words[i] = rotate(
+          words[i - 3] ^ words[i - 8] ^ words[i - 14] ^ words[i - 16], 1);
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3],
+             e = state[4];
+
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+
+      if (i < 20)
+        f = (b & c) | (~b & d), k = 0x5A827999;
+      else if (i < 40)
+        f = b ^ c ^ d, k = 0x6ED9EBA1;
+      else if (i < 60)
+        f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+      else
+        f = b ^ c ^ d, k = 0xCA62C1D6;
+
+      uint32_t temp = rotate(a, 5) + f + e + k + words[i];
+      e = d;
+      d = c;
+      c = rotate(b, 30);
+      b = a;
+      a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+  }
+
+  std::array<unsigned char, 20> digest;
+  for (int i = 0; i < 20; i++)
+    digest[i] = static_cast<unsigned char>(state[i / 4] >> (24 - (i % 4) * 8));
+
+  return digest;
+}
+
+static std::string base64(const unsigned char *data, size_t length) {
+  static const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t group = static_cast<uint32_t>(data[i]) << 16;
+    if (i + 1 < length)
+      group |= static_cast<uint32_t>(data[i + 1]) << 8;
+    if (i + 2 < length)
+      group |= data[i + 2];
+
+    encoded.push_back(alphabet[(group >> 18) & 63]);
+    encoded.push_back(alphabet[(group >> 12) & 63]);
+    encoded.push_back(i + 1 < length ? alphabet[(group >> 6) & 63] : '=');
+    encoded.push_back(i + 2 < length ? alphabet[group & 63] : '=');
+  }
+
+  return encoded;
+}
+
+static bool is_control(WebSocketOpcode opcode) {
+  return static_cast<uint8_t>(opcode) & 0x8;
+}
+
+WebSocketParseStatus parse_websocket_frame(std::string &buffer, size_t offset,
+                                           size_t max_payload,
+                                           WebSocketFrame &frame) {
+  size_t available = buffer.size() - offset;
+  if (available < 2)
+    return WebSocketParseStatus::Incomplete;
+
+  const unsigned char *bytes =
+      reinterpret_cast<const unsigned char *>(buffer.data() + offset);
+  uint8_t opcode = bytes[0] & 0x0f;
+
+  frame.fin = bytes[0] & 0x80;
+  frame.opcode = static_cast<WebSocketOpcode>(opcode);
+  frame.close_code = 1002;
+
+  if ((bytes[0] & 0x70) || !(bytes[1] & 0x80) ||
+      (opcode > 0x2 && opcode < 0x8) || opcode > 0xA)
+    return WebSocketParseStatus::Error;
+
+  uint64_t payload_length = bytes[1] & 0x7f;
+  size_t header_length = 2;
+
+  if (payload_length == 126) {
+    header_length = 4;
+    if (available < header_length)
+      return WebSocketParseStatus::Incomplete;
+
+    payload_length = static_cast<uint64_t>(bytes[2]) << 8 | bytes[3];
+  } else if (payload_length == 127) {
+    header_length = 10;
+    if (available < header_length)
+      return WebSocketParseStatus::Incomplete;
+
+    payload_length = 0;
+    for (int i = 2; i < 10; i++)
+      payload_length = payload_length << 8 | bytes[i];
+  }
+
+  if (is_control(frame.opcode) && (!frame.fin || payload_length > 125))
+    return WebSocketParseStatus::Error;
+  else if (payload_length > max_payload) {
+    frame.close_code = 1009;
+    return WebSocketParseStatus::Error;
+  }
+
+  header_length += 4;
+  if (available < header_length + payload_length)
+    return WebSocketParseStatus::Incomplete;
+
+  unsigned char mask[4];
+  std::memcpy(mask, bytes + header_length - 4, sizeof(mask));
+
+  char *payload = buffer.data() + offset + header_length;
+  websocket_unmask(payload, payload_length, mask);
+
+  frame.payload = std::string_view(payload, payload_length);
+  frame.length = header_length + payload_length;
+
+  return WebSocketParseStatus::Complete;
+}
+
+void websocket_unmask(char *data, size_t length, const unsigned char mask[4]) {
+  size_t i = 0;
+
+#ifdef __SSE2__
+  uint32_t key;
+  std::memcpy(&key, mask, sizeof(key));
+  __m128i wide = _mm_set1_epi32(static_cast<int>(key));
+
+  for (; i + 16 <= length; i += 16) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i),
+                     _mm_xor_si128(block, wide));
+  }
+#else
+  uint32_t key;
+  std::memcpy(&key, mask, sizeof(key));
+  uint64_t wide = static_cast<uint64_t>(key) << 32 | key;
+
+  for (; i + 8 <= length; i += 8) {
+    uint64_t block;
+    std::memcpy(&block, data + i, sizeof(block));
+
+    block ^= wide;
+    std::memcpy(data + i, &block, sizeof(block));
+  }
+#endif
+
+  for (; i < length; i++)
+    data[i] ^= static_cast<char>(mask[i & 3]);
+}
+
+std::string encode_websocket_frame(WebSocketOpcode opcode,
+                                   std::string_view payload) {
+  std::string frame;
+  frame.reserve(payload.size() + 10);
+  frame.push_back(static_cast<char>(0x80 | static_cast<uint8_t>(opcode)));
+
+  if (payload.size() < 126)
+    frame.push_back(static_cast<char>(payload.size()));
+  else if (payload.size() <= 0xffff) {
+    frame.push_back(static_cast<char>(126));
+    frame.push_back(static_cast<char>(payload.size() >> 8));
+    frame.push_back(static_cast<char>(payload.size() & 0xff));
+  } else {
+    frame.push_back(static_cast<char>(127));
+    for (int shift = 56; shift >= 0; shift -= 8)
+      frame.push_back(static_cast<char>(
+          (static_cast<uint64_t>(payload.size()) >> shift) & 0xff));
+  }
+
+  frame.append(payload);
+  return frame;
+}
+
+std::string encode_websocket_close(uint16_t code, std::string_view reason) {
+  if (code == 1005)
+    return encode_websocket_frame(WebSocketOpcode::Close, "");
+
+  std::string payload;
+  payload.push_back(static_cast<char>(code >> 8));
+  payload.push_back(static_cast<char>(code & 0xff));
+  payload.append(reason.substr(0, 123));
+
+  return encode_websocket_frame(WebSocketOpcode::Close, payload);
+}
+
+bool is_valid_utf8(std::string_view text) {
+  const unsigned char *bytes =
+      reinterpret_cast<const unsigned char *>(text.data());
+  size_t length = text.size(), i = 0;
+
+  while (i < length) {
+    while (i + 8 <= length) {
+      uint64_t block;
+      std::memcpy(&block, bytes + i, sizeof(block));
+
+      if (block & 0x8080808080808080ULL)
+        break;
+      i += 8;
+    }
+
+    if (i >= length)
+      break;
+    else if (bytes[i] < 0x80) {
+      i++;
+      continue;
+    }
+
+    size_t extra;
+    uint32_t code_point, minimum;
+
+    if ((bytes[i] & 0xe0) == 0xc0)
+      extra = 1, code_point = bytes[i] & 0x1f, minimum = 0x80;
+    else if ((bytes[i] & 0xf0) == 0xe0)
+      extra = 2, code_point = bytes[i] & 0x0f, minimum = 0x800;
+    else if ((bytes[i] & 0xf8) == 0xf0)
+      extra = 3, code_point = bytes[i] & 0x07, minimum = 0x10000;
+    else
+      return false;
+
+    if (length - i <= extra)
+      return false;
+
+    for (size_t j = 1; j <= extra; j++) {
+      if ((bytes[i + j] & 0xc0) != 0x80)
+        return false;
+
+      code_point = code_point << 6 | (bytes[i + j] & 0x3f);
+    }
+
+    if (code_point < minimum || code_point > 0x10ffff ||
+        (code_point >= 0xd800 && code_point <= 0xdfff))
+      return false;
+
+    i += extra + 1;
+  }
+
+  return true;
+}
+
+std::string websocket_accept_key(std::string_view key) {
+  std::array<unsigned char, 20> digest =
+      sha1(std::string(key) + websocket_guid);
+  return base64(digest.data(), digest.size());
+}
+
+WebSocket::WebSocket(EventLoop *event_loop, uint64_t identifier,
+                     int descriptor, std::string address)
+    : mutex(), loop(event_loop), connection_id(identifier), fd(descriptor),
+      remote(std::move(address)), events(), dispatching(false) {}
+
+bool WebSocket::send(std::string_view message, bool binary) {
+  return this->send_frame(std::make_shared<const std::string>(
+      encode_websocket_frame(binary ? WebSocketOpcode::Binary
+                                    : WebSocketOpcode::Text,
+                             message)));
+}
+
+bool WebSocket::send_frame(std::shared_ptr<const std::string> frame,
+                           bool closing) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!this->loop)
+    return false;
+
+  this->loop->post_frames(
+      {std::move(frame), {{this->fd, this->connection_id}}, closing});
+  return true;
+}
+
+void WebSocket::close(uint16_t code, std::string_view reason) {
+  this->send_frame(
+      std::make_shared<const std::string>(encode_websocket_close(code, reason)),
+      true);
+}
+
+bool WebSocket::is_open() const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->loop != nullptr;
+}
+
+const std::string &WebSocket::remote_address() const { return this->remote; }
+
+EventLoop *WebSocket::target(uint64_t &identifier, int &descriptor) const {
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  identifier = this->connection_id;
+  descriptor = this->fd;
+  return this->loop;
+}
+
+void WebSocket::detach() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->loop = nullptr;
+}
+
+void WebSocket::dispatch(Purple::Concurrent::TaskletManager &workers,
+                         std::function<void()> event) {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->events.push_back(std::move(event));
+
+    if (this->dispatching)
+      return;
+
+    this->dispatching = true;
+  }
+
+  workers.go([self = this->shared_from_this(), workers = &workers] {
+    self->drain(workers);
+  });
+}
+
+void WebSocket::drain(Purple::Concurrent::TaskletManager *workers) {
+  std::deque<std::function<void()>> batch;
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    batch.swap(this->events);
+  }
+
+  for (std::function<void()> &event : batch)
+    event();
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->events.empty()) {
+      this->dispatching = false;
+      return;
+    }
+  }
+
+  workers->go([self = this->shared_from_this(), workers] {
+    self->drain(workers);
+  });
+}
+
+void WebSocketGroup::add(std::shared_ptr<WebSocket> socket) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->members.push_back(std::move(socket));
+}
+
+void WebSocketGroup::remove(const std::shared_ptr<WebSocket> &socket) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->members.erase(
+      std::remove(this->members.begin(), this->members.end(), socket),
+      this->members.end());
+}
+
+size_t WebSocketGroup::size() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->members.size();
+}
+
+size_t WebSocketGroup::broadcast(std::string_view message, bool binary) {
+  std::shared_ptr<const std::string> frame =
+      std::make_shared<const std::string>(encode_websocket_frame(
+          binary ? WebSocketOpcode::Binary : WebSocketOpcode::Text, message));
+  std::unordered_map<EventLoop *, std::vector<std::pair<int, uint64_t>>>
+      by_loop;
+  size_t count = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    auto open_end = std::remove_if(
+        this->members.begin(), this->members.end(),
+        [&](const std::shared_ptr<WebSocket> &socket) {
+          uint64_t identifier = 0;
+          int descriptor = -1;
+          EventLoop *loop = socket->target(identifier, descriptor);
+
+          if (!loop)
+            return true;
+
+          by_loop[loop].push_back({descriptor, identifier});
+          count++;
+
+          return false;
+        });
+
+    this->members.erase(open_end, this->members.end());
+  }
+
+  for (auto &[loop, targets] : by_loop)
+    loop->post_frames({frame, std::move(targets), false});
+
+  return count;
+}
+
+} // namespace Purple::Net